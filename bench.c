@@ -0,0 +1,1188 @@
+#define _POSIX_C_SOURCE 200809L
+#include <json.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+constexpr double DEFAULT_MIN_SECONDS = 0.1;
+constexpr size_t COUNT_FORMATS = 2;
+// Largest document encoded to a tape; Numeric corpora grow several times over
+constexpr size_t MAX_TAPE_SOURCE_SIZE = 200 << 20;
+constexpr char TAPE_PATH[] = "bench.tape";
+// Longest number literal copied for the strtod baseline
+constexpr size_t MAX_LITERAL_SIZE = 64;
+constexpr size_t COUNT_COLUMN_KEYS = 2;
+// Copies of a document read back by the ingestion rows, up to a size limit
+constexpr size_t INGEST_FILES = 32;
+constexpr size_t MAX_INGEST_SIZE = 1 << 20;
+constexpr size_t INGEST_BUFFERS = 8;
+constexpr size_t INGEST_WORKERS = 4;
+constexpr char INGEST_PATH[] = "bench_ingest_%zu.json";
+// Largest document diffed against a copy of itself with one member changed
+constexpr size_t MAX_PATCH_SIZE = 16 << 20;
+// Items of the array of a corpus looked up as separate records
+constexpr size_t PREDICT_RECORDS = 64;
+// Bytes per item of the smallest array of objects in any corpus
+constexpr size_t MIN_ROW_SIZE = 32;
+
+// Size profile the library was built with, see json.h
+#if defined(JSON_PROFILE_TINY)
+constexpr char PROFILE[] = "tiny";
+#elif defined(JSON_PROFILE_LARGE)
+constexpr char PROFILE[] = "large";
+#elif defined(JSON_PROFILE_DYNAMIC)
+constexpr char PROFILE[] = "dynamic";
+#else
+constexpr char PROFILE[] = "default";
+#endif
+
+typedef struct
+{
+  char *str;
+  size_t length;
+  size_t capacity;
+} writer_t;
+
+typedef struct
+{
+  const char *name;
+  // Fills the writer with a document of roughly the writer capacity; Every
+  // document ends with a numeric "count" member so the last key is known
+  bool (*generate)(writer_t *, bool pretty);
+  // Top-level member holding an array MapStringArray can iterate, if any
+  const char *arrayKey;
+  // Integer members of every item of arrayKey, extracted as columns, if any
+  const char *columnKeys[COUNT_COLUMN_KEYS];
+} corpus_t;
+
+typedef struct
+{
+  const char *corpus;
+  const char *format;
+  size_t size;
+  const char *function;
+  size_t bytes;
+  size_t iterations;
+  double seconds;
+  size_t allocations;
+} sample_t;
+
+// Allocation counting through the linker: -Wl,--wrap=malloc and friends
+static size_t allocations = 0;
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+
+void *__wrap_malloc(size_t size)
+{
+  allocations++;
+  return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t count, size_t size)
+{
+  allocations++;
+  return __real_calloc(count, size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size)
+{
+  allocations++;
+  return __real_realloc(ptr, size);
+}
+
+static double GetSeconds()
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (double)now.tv_sec + (double)now.tv_nsec / 1e9;
+}
+
+// Keeps the compiler from discarding the work being measured
+static void Consume(const void *ptr)
+{
+  __asm__ volatile("" : : "r"(ptr) : "memory");
+}
+
+static bool Append(writer_t *writer, const char *format, ...)
+{
+  va_list args;
+  va_start(args, format);
+  const size_t available = writer->capacity - writer->length;
+  const int written =
+      vsnprintf(&writer->str[writer->length], available, format, args);
+  va_end(args);
+
+  if (written < 0 || (size_t)written >= available)
+  {
+    writer->str[writer->length] = '\0';
+    return false;
+  }
+  writer->length += written;
+  return true;
+}
+
+static bool AppendBreak(writer_t *writer, bool pretty, size_t depth)
+{
+  if (!pretty)
+  {
+    return true;
+  }
+  if (!Append(writer, "\n"))
+  {
+    return false;
+  }
+  for (size_t i = 0; i < depth; i++)
+  {
+    if (!Append(writer, "  "))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Room kept free for the closing members of every generated document
+constexpr size_t TAIL_RESERVE = 64;
+
+static bool HasRoom(const writer_t *writer, size_t needed)
+{
+  return writer->length + needed + TAIL_RESERVE < writer->capacity;
+}
+
+static bool AppendTail(writer_t *writer, bool pretty)
+{
+  return AppendBreak(writer, pretty, 1) &&
+         Append(writer, pretty ? "\"count\": %zu.5" : "\"count\":%zu.5",
+                writer->length) &&
+         AppendBreak(writer, pretty, 0) && Append(writer, "}");
+}
+
+static const char *Separator(bool pretty)
+{
+  return pretty ? ": " : ":";
+}
+
+static bool GenerateWide(writer_t *writer, bool pretty)
+{
+  if (!Append(writer, "{"))
+  {
+    return false;
+  }
+  for (size_t i = 0; HasRoom(writer, 48); i++)
+  {
+    AppendBreak(writer, pretty, 1);
+    switch (i % 3)
+    {
+    case 0:
+      Append(writer, "\"key%zu\"%s%zu,", i, Separator(pretty), i * 7);
+      break;
+    case 1:
+      Append(writer, "\"key%zu\"%s\"value%zu\",", i, Separator(pretty), i);
+      break;
+    default:
+      Append(writer, "\"key%zu\"%s%s,", i, Separator(pretty),
+             i % 2 ? "true" : "false");
+      break;
+    }
+  }
+  return AppendTail(writer, pretty);
+}
+
+// Deepest chain of objects; The scanners reject nesting past JSONMAXDEPTH, so
+// larger documents hold several chains side by side. The smaller profiles
+// stay a few levels under their limit
+constexpr size_t DEEP_MAX_DEPTH = JSONMAXDEPTH > 1008 ? 1000 : JSONMAXDEPTH - 8;
+
+static bool GenerateDeep(writer_t *writer, bool pretty)
+{
+  if (!Append(writer, "{"))
+  {
+    return false;
+  }
+
+  for (size_t chain = 0;; chain++)
+  {
+    // Every level costs the key and both braces, plus the indentation on both
+    // sides when pretty-printed. The leaf is indented one level further
+    size_t depth = 0, cost = 24; // Number of the chain
+    while (depth < DEEP_MAX_DEPTH)
+    {
+      const size_t levelCost = pretty ? 9 + 4 * (depth + 1) : 6;
+      const size_t leafCost = pretty ? 12 + 2 * (depth + 2) : 10;
+      if (!HasRoom(writer, cost + levelCost + leafCost + TAIL_RESERVE))
+      {
+        break;
+      }
+      cost += levelCost;
+      depth++;
+    }
+    if (depth == 0)
+    {
+      break;
+    }
+
+    AppendBreak(writer, pretty, 1);
+    Append(writer, "\"chain%zu\"%s{", chain, Separator(pretty));
+    for (size_t d = 2; d <= depth; d++)
+    {
+      AppendBreak(writer, pretty, d);
+      Append(writer, "\"n\"%s{", Separator(pretty));
+    }
+    AppendBreak(writer, pretty, depth + 1);
+    Append(writer, "\"leaf\"%s1", Separator(pretty));
+    for (size_t d = depth; d >= 1; d--)
+    {
+      AppendBreak(writer, pretty, d);
+      Append(writer, "}");
+    }
+    if (!Append(writer, ","))
+    {
+      return false;
+    }
+  }
+
+  return AppendTail(writer, pretty);
+}
+
+static bool GenerateNumeric(writer_t *writer, bool pretty)
+{
+  if (!Append(writer, "{") || !AppendBreak(writer, pretty, 1) ||
+      !Append(writer, "\"values\"%s[", Separator(pretty)))
+  {
+    return false;
+  }
+  for (size_t i = 0; HasRoom(writer, 32); i++)
+  {
+    AppendBreak(writer, pretty, 2);
+    Append(writer, i ? ",%zu.%zu" : "%zu.%zu", i * 31 % 100000, i % 97);
+  }
+  return AppendBreak(writer, pretty, 1) && Append(writer, "],") &&
+         AppendTail(writer, pretty);
+}
+
+static bool GenerateStrings(writer_t *writer, bool pretty)
+{
+  if (!Append(writer, "{") || !AppendBreak(writer, pretty, 1) ||
+      !Append(writer, "\"names\"%s[", Separator(pretty)))
+  {
+    return false;
+  }
+  for (size_t i = 0; HasRoom(writer, 96); i++)
+  {
+    AppendBreak(writer, pretty, 2);
+    Append(writer,
+           i ? ",\"Lorem ipsum dolor sit amet %zu consectetur adipiscing\""
+             : "\"Lorem ipsum dolor sit amet %zu consectetur adipiscing\"",
+           i);
+  }
+  return AppendBreak(writer, pretty, 1) && Append(writer, "],") &&
+         AppendTail(writer, pretty);
+}
+
+// Shaped after twitter.json: an array of status records
+static bool GenerateTwitter(writer_t *writer, bool pretty)
+{
+  const char *sep = Separator(pretty);
+  if (!Append(writer, "{") || !AppendBreak(writer, pretty, 1) ||
+      !Append(writer, "\"statuses\"%s[", sep))
+  {
+    return false;
+  }
+  for (size_t i = 0; HasRoom(writer, 320); i++)
+  {
+    AppendBreak(writer, pretty, 2);
+    Append(writer,
+           "%s{\"id\"%s%zu, \"text\"%s\"Status update number %zu from the "
+           "benchmark corpus\", \"user_name\"%s\"user%zu\", "
+           "\"followers_count\"%s%zu, \"retweet_count\"%s%zu, "
+           "\"favorited\"%sfalse, \"lang\"%s\"en\"}",
+           i ? "," : "", sep, 505874924095815681 + i, sep, i, sep, i % 100,
+           sep, i * 13 % 5000, sep, i % 7, sep, sep);
+  }
+  return AppendBreak(writer, pretty, 1) && Append(writer, "],") &&
+         AppendTail(writer, pretty);
+}
+
+// Shaped after citm_catalog.json: an id to name dictionary and a list of
+// performances
+static bool GenerateCitm(writer_t *writer, bool pretty)
+{
+  const char *sep = Separator(pretty);
+  if (!Append(writer, "{") || !AppendBreak(writer, pretty, 1) ||
+      !Append(writer, "\"areaNames\"%s{", sep))
+  {
+    return false;
+  }
+  const size_t half = writer->capacity / 2;
+  for (size_t i = 0; writer->length < half && HasRoom(writer, 64); i++)
+  {
+    AppendBreak(writer, pretty, 2);
+    Append(writer, "%s\"%zu\"%s\"Arriere-scene central %zu\"", i ? "," : "",
+           205705993 + i, sep, i);
+  }
+  AppendBreak(writer, pretty, 1);
+  Append(writer, "},");
+  AppendBreak(writer, pretty, 1);
+  Append(writer, "\"performances\"%s[", sep);
+  for (size_t i = 0; HasRoom(writer, 192); i++)
+  {
+    AppendBreak(writer, pretty, 2);
+    Append(writer,
+           "%s{\"eventId\"%s%zu, \"id\"%s%zu, \"logo\"%snull, "
+           "\"name\"%snull, \"start\"%s%zu, \"venueCode\"%s\"PLEYEL\"}",
+           i ? "," : "", sep, 138586341 + i, sep, 339887544 + i, sep, sep, sep,
+           1372701600000 + i * 86400000, sep);
+  }
+  return AppendBreak(writer, pretty, 1) && Append(writer, "],") &&
+         AppendTail(writer, pretty);
+}
+
+// Shaped after canada.json: long runs of coordinate pairs
+static bool GenerateCanada(writer_t *writer, bool pretty)
+{
+  const char *sep = Separator(pretty);
+  if (!Append(writer, "{") || !AppendBreak(writer, pretty, 1) ||
+      !Append(writer, "\"type\"%s\"Polygon\",", sep) ||
+      !AppendBreak(writer, pretty, 1) ||
+      !Append(writer, "\"coordinates\"%s[", sep))
+  {
+    return false;
+  }
+  for (size_t i = 0; HasRoom(writer, 64); i++)
+  {
+    AppendBreak(writer, pretty, 2);
+    Append(writer, "%s[-%zu.%06zu,%zu.%06zu]", i ? "," : "", 65 + i % 30,
+           i * 7919 % 1000000, 43 + i % 20, i * 104729 % 1000000);
+  }
+  return AppendBreak(writer, pretty, 1) && Append(writer, "],") &&
+         AppendTail(writer, pretty);
+}
+
+static const corpus_t CORPORA[] = {
+    {"wide", GenerateWide, nullptr, {}},
+    {"deep", GenerateDeep, nullptr, {}},
+    {"numeric", GenerateNumeric, nullptr, {}},
+    {"strings", GenerateStrings, "names", {}},
+    {"twitter", GenerateTwitter, "statuses", {"id", "followers_count"}},
+    {"citm", GenerateCitm, "performances", {"eventId", "start"}},
+    {"canada", GenerateCanada, "coordinates", {}},
+};
+constexpr size_t COUNT_CORPORA = sizeof(CORPORA) / sizeof(CORPORA[0]);
+
+static const size_t SIZES[] = {
+    1 << 10, 16 << 10, 60 << 10, 1 << 20, 16 << 20, 200 << 20, 500 << 20,
+};
+constexpr size_t COUNT_SIZES = sizeof(SIZES) / sizeof(SIZES[0]);
+
+static size_t mapItems = 0;
+
+static void CountItem(char *item, size_t, void *)
+{
+  Consume(item);
+  mapItems++;
+}
+
+static void PrintSample(const sample_t *sample, bool csv)
+{
+  const double nsPerOp = sample->seconds * 1e9 / sample->iterations;
+  const double mbPerSec =
+      (double)sample->bytes * sample->iterations / sample->seconds / 1e6;
+  const double allocsPerOp = (double)sample->allocations / sample->iterations;
+  if (csv)
+  {
+    printf("%s,%s,%s,%zu,%s,%zu,%zu,%.1f,%.2f,%.2f\n", PROFILE,
+           sample->corpus, sample->format, sample->size, sample->function,
+           sample->bytes, sample->iterations, nsPerOp, mbPerSec, allocsPerOp);
+    return;
+  }
+  printf("%-8s %-9s %10zu  %-26s %12.1f ns/op %10.2f MB/s %6.2f allocs/op\n",
+         sample->corpus, sample->format, sample->size, sample->function,
+         nsPerOp, mbPerSec, allocsPerOp);
+}
+
+// Repeats the operation until the minimum run time has elapsed
+#define MEASURE(sample, minSeconds, operation)                                 \
+  do                                                                           \
+  {                                                                            \
+    const size_t startAllocations = allocations;                               \
+    const double startTime = GetSeconds();                                     \
+    size_t iterations = 0;                                                     \
+    double elapsed = 0;                                                        \
+    do                                                                         \
+    {                                                                          \
+      operation;                                                               \
+      iterations++;                                                            \
+    } while ((elapsed = GetSeconds() - startTime) < (minSeconds));             \
+    (sample).iterations = iterations;                                          \
+    (sample).seconds = elapsed;                                                \
+    (sample).allocations = allocations - startAllocations;                     \
+  } while (0)
+
+static status_json_t RunStringFunctions(const corpus_t *corpus,
+                                        sample_t *sample,
+                                        const writer_t *writer,
+                                        double minSeconds, bool csv,
+                                        string_json_t *json,
+                                        string_json_t *result)
+{
+  status_json_t status = FUNC_SUCCESS;
+  sample->function = "ConvertStringToJson";
+  sample->bytes = writer->length;
+  MEASURE(*sample, minSeconds,
+          status |= ConvertStringToJson(writer->str, json);
+          Consume(json));
+  PrintSample(sample, csv);
+
+  // The last key is the worst case for the key scanner
+  sample->function = "GetJsonProperty3";
+  MEASURE(*sample, minSeconds,
+          status |= GetJsonProperty3(*json, result, "count");
+          Consume(result));
+  PrintSample(sample, csv);
+
+  // Repeated lookups of the same key are served from the cache
+  json_cache_t *cache = malloc(sizeof(json_cache_t));
+  if (cache == nullptr)
+  {
+    return MEMORY_FAILURE;
+  }
+  InitJsonCache(cache);
+  sample->function = "CachedGetProperty";
+  MEASURE(*sample, minSeconds,
+          status |= CachedGetProperty(cache, json, result, "count");
+          Consume(result));
+  PrintSample(sample, csv);
+  free(cache);
+
+  double number = 0;
+  sample->function = "ConvertJsonToStandardType";
+  sample->bytes = result->length;
+  MEASURE(*sample, minSeconds,
+          status |= ConvertJsonToStandardType(*result, JSON_DOUBLE, &number);
+          Consume(&number));
+  PrintSample(sample, csv);
+
+  if (corpus->arrayKey != nullptr)
+  {
+    // Routing on the type of a large member: the probe stops at its first
+    // byte where the lookup copies the whole member
+    json_view_t probe;
+    sample->function = "ProbeJsonProperty array";
+    sample->bytes = writer->length;
+    MEASURE(*sample, minSeconds,
+            status |= ProbeJsonProperty(json, corpus->arrayKey, &probe);
+            Consume(&probe));
+    PrintSample(sample, csv);
+
+    sample->function = "GetJsonProperty3 array";
+    MEASURE(*sample, minSeconds,
+            status |= GetJsonProperty3(*json, result, corpus->arrayKey);
+            Consume(result));
+    PrintSample(sample, csv);
+
+    result->str[result->length] = '\0';
+    sample->function = "MapStringArray";
+    sample->bytes = result->length;
+    MEASURE(*sample, minSeconds,
+            MapStringArray(CountItem, result->str, nullptr, result->length));
+    PrintSample(sample, csv);
+  }
+
+  return status;
+}
+
+// Views read the generated text directly, so they run at every size. This is
+// the sparse access pattern: one member out of a large record
+static status_json_t RunViewFunctions(sample_t *sample, const writer_t *writer,
+                                      double minSeconds, bool csv)
+{
+  json_view_t root, value;
+  status_json_t status = ViewJson(writer->str, writer->length, &root);
+  sample->function = "ViewGetField";
+  sample->bytes = writer->length;
+  MEASURE(*sample, minSeconds,
+          status |= ViewGetField(root, "count", &value);
+          Consume(&value));
+  PrintSample(sample, csv);
+
+  double number = 0;
+  sample->function = "ViewGetDouble";
+  sample->bytes = sizeof(number);
+  MEASURE(*sample, minSeconds,
+          status |= ViewGetDouble(value, &number);
+          Consume(&number));
+  PrintSample(sample, csv);
+
+  // The same literal parsed in place, and through the NUL-terminated copy
+  // that strtod needs, which is how numbers used to be converted
+  size_t length = 0;
+  while (length < value.length && length < MAX_LITERAL_SIZE - 1 &&
+         strchr("+-.eE0123456789", value.str[length]) != nullptr)
+  {
+    length++;
+  }
+  sample->function = "ParseJsonDouble";
+  MEASURE(*sample, minSeconds,
+          status |= ParseJsonDouble(value.str, length, &number);
+          Consume(&number));
+  PrintSample(sample, csv);
+
+  char literal[MAX_LITERAL_SIZE];
+  sample->function = "strtod";
+  MEASURE(*sample, minSeconds, memcpy(literal, value.str, length);
+          literal[length] = '\0'; number = strtod(literal, nullptr);
+          Consume(&number));
+  PrintSample(sample, csv);
+  return status;
+}
+
+static bool CountNumber(json_view_t view, size_t, void *data)
+{
+  Consume(view.str);
+  (*(size_t *)data)++;
+  return true;
+}
+
+// The dense access pattern: every token of the document in one pass
+static status_json_t RunEventFunctions(sample_t *sample,
+                                       const writer_t *writer,
+                                       double minSeconds, bool csv)
+{
+  size_t numbers = 0;
+  const event_handler_json_t handler = {.onNumber = CountNumber,
+                                        .data = &numbers};
+  status_json_t status = FUNC_SUCCESS;
+  sample->function = "ParseJsonEvents";
+  sample->bytes = writer->length;
+  MEASURE(*sample, minSeconds,
+          status |= ParseJsonEvents(writer->str, writer->length, &handler));
+  PrintSample(sample, csv);
+  return status;
+}
+
+// What ExtractJsonColumns replaces: one field lookup per row and key
+static status_json_t ReadColumnsPerRow(json_view_t array,
+                                       const column_json_t *columns,
+                                       size_t count)
+{
+  json_cursor_t cursor;
+  json_view_t item, value;
+  status_json_t status = ViewIterate(array, &cursor);
+  for (size_t row = 0; ViewNextItem(&cursor, &item) == FUNC_SUCCESS; row++)
+  {
+    for (size_t i = 0; i < count; i++)
+    {
+      status |= ViewGetField(item, columns[i].key, &value);
+      status |= ViewGetLong(value, &((long *)columns[i].data)[row]);
+    }
+  }
+  return status;
+}
+
+// Decodes the integer members of every item of the array into columns
+static status_json_t RunColumnFunctions(const corpus_t *corpus,
+                                        sample_t *sample,
+                                        const writer_t *writer,
+                                        double minSeconds, bool csv)
+{
+  json_view_t root, array;
+  if (corpus->columnKeys[0] == nullptr)
+    return FUNC_SUCCESS;
+  if (ViewJson(writer->str, writer->length, &root) != FUNC_SUCCESS ||
+      ViewGetField(root, corpus->arrayKey, &array) != FUNC_SUCCESS)
+  {
+    return MEMORY_FAILURE;
+  }
+
+  const size_t capacity = writer->length / MIN_ROW_SIZE + 1;
+  column_json_t columns[COUNT_COLUMN_KEYS];
+  status_json_t status = FUNC_SUCCESS;
+  for (size_t i = 0; i < COUNT_COLUMN_KEYS; i++)
+  {
+    columns[i] = (column_json_t){corpus->columnKeys[i], JSON_LONG,
+                                 malloc(capacity * sizeof(long)), nullptr};
+    if (columns[i].data == nullptr)
+      status = MEMORY_FAILURE;
+  }
+
+  size_t rows = 0;
+  sample->function = "ExtractJsonColumns";
+  sample->bytes = array.length;
+  if (status == FUNC_SUCCESS)
+  {
+    MEASURE(*sample, minSeconds,
+            status |= ExtractJsonColumns(array, columns, COUNT_COLUMN_KEYS,
+                                         capacity, &rows);
+            Consume(columns[0].data));
+    PrintSample(sample, csv);
+  }
+
+  sample->function = "ViewGetField per row";
+  if (status == FUNC_SUCCESS)
+  {
+    MEASURE(*sample, minSeconds,
+            status |= ReadColumnsPerRow(array, columns, COUNT_COLUMN_KEYS);
+            Consume(columns[0].data));
+    PrintSample(sample, csv);
+  }
+
+  for (size_t i = 0; i < COUNT_COLUMN_KEYS; i++)
+    free(columns[i].data);
+  return status;
+}
+
+// Copies out every key of every item of the array, either into a heap block
+// of its own, as a decoder without interning does, or through the table
+static status_json_t DecodeKeys(json_view_t array, json_intern_t *table)
+{
+  json_cursor_t rows, fields;
+  json_view_t item, key, value;
+  status_json_t status = ViewIterate(array, &rows);
+  while (ViewNextItem(&rows, &item) == FUNC_SUCCESS)
+  {
+    status |= ViewIterate(item, &fields);
+    while (ViewNextField(&fields, &key, &value) == FUNC_SUCCESS)
+    {
+      const char *str;
+      size_t length;
+      if (table != nullptr)
+      {
+        status |= ViewGetInternedString(table, key, &str);
+        Consume(str);
+        continue;
+      }
+
+      status |= ViewGetString(key, &str, &length);
+      char *copy = malloc(length + 1);
+      if (copy == nullptr)
+        return MEMORY_FAILURE;
+      memcpy(copy, str, length);
+      copy[length] = '\0';
+      Consume(copy);
+      free(copy);
+    }
+  }
+  return status;
+}
+
+// Every item of the array repeats the same key set, which is the workload
+// interning is meant for
+static status_json_t RunInternFunctions(const corpus_t *corpus,
+                                        sample_t *sample,
+                                        const writer_t *writer,
+                                        double minSeconds, bool csv)
+{
+  json_view_t root, array;
+  if (corpus->columnKeys[0] == nullptr)
+    return FUNC_SUCCESS;
+  json_intern_t *table = malloc(sizeof(json_intern_t));
+  if (table == nullptr ||
+      ViewJson(writer->str, writer->length, &root) != FUNC_SUCCESS ||
+      ViewGetField(root, corpus->arrayKey, &array) != FUNC_SUCCESS)
+  {
+    free(table);
+    return MEMORY_FAILURE;
+  }
+  InitJsonIntern(table);
+
+  status_json_t status = FUNC_SUCCESS;
+  sample->function = "malloc per key";
+  sample->bytes = array.length;
+  MEASURE(*sample, minSeconds, status |= DecodeKeys(array, nullptr));
+  PrintSample(sample, csv);
+
+  sample->function = "ViewGetInternedString";
+  MEASURE(*sample, minSeconds, status |= DecodeKeys(array, table));
+  PrintSample(sample, csv);
+
+  free(table);
+  return status;
+}
+
+// Diffs the document against a copy with the last member changed, then
+// applies the resulting patch. Every other member is skipped with a memcmp
+static status_json_t RunPatchFunctions(sample_t *sample, const writer_t *writer,
+                                       double minSeconds, bool csv)
+{
+  const size_t capacity = writer->length + 64;
+  char *modified = malloc(writer->length);
+  char *output = malloc(capacity);
+  char patch[64];
+  json_view_t original, changed, value, patchView;
+  size_t length;
+  status_json_t status = MEMORY_FAILURE;
+  if (modified != nullptr && output != nullptr)
+  {
+    memcpy(modified, writer->str, writer->length);
+    status = ViewJson(writer->str, writer->length, &original);
+    status |= ViewJson(modified, writer->length, &changed);
+    status |= ViewGetField(changed, "count", &value);
+  }
+  if (status != FUNC_SUCCESS)
+  {
+    free(modified);
+    free(output);
+    return MEMORY_FAILURE;
+  }
+  char *digit = &modified[value.str - modified];
+  *digit = *digit == '1' ? '2' : '1';
+
+  sample->function = "DiffJson";
+  sample->bytes = writer->length;
+  MEASURE(*sample, minSeconds,
+          status |= DiffJson(original, changed, patch, sizeof(patch), &length);
+          Consume(patch));
+  PrintSample(sample, csv);
+
+  status |= ViewJson(patch, length, &patchView);
+  sample->function = "ApplyJsonMergePatch";
+  MEASURE(*sample, minSeconds,
+          status |= ApplyJsonMergePatch(original, patchView, output, capacity,
+                                        &length);
+          Consume(output));
+  PrintSample(sample, csv);
+
+  free(modified);
+  free(output);
+  return status;
+}
+
+// Looks up the column keys in every record, each one copied into the same
+// buffer first as a stream of records would be
+static status_json_t LookUpRecords(const corpus_t *corpus,
+                                   const json_view_t *items,
+                                   const size_t *lengths, size_t count,
+                                   json_parser_t *parser,
+                                   json_predictor_t *predictor,
+                                   string_json_t *record,
+                                   string_json_t *result)
+{
+  status_json_t status = FUNC_SUCCESS;
+  for (size_t i = 0; i < count; i++)
+  {
+    status |= ReserveJsonString(record, lengths[i]);
+    memcpy(record->str, items[i].str, lengths[i]);
+    record->length = lengths[i];
+    record->type = JOBJECT;
+    for (size_t k = 0; k < COUNT_COLUMN_KEYS; k++)
+    {
+      status |= predictor != nullptr
+                    ? PredictedGetProperty(predictor, record, result,
+                                           corpus->columnKeys[k])
+                    : ParserGetProperty(parser, record, result,
+                                        corpus->columnKeys[k]);
+      Consume(result);
+    }
+  }
+  return status;
+}
+
+// The items of the array of the corpus share one layout with values of
+// varying length, which is the workload key-order prediction is meant for
+static status_json_t RunPredictFunctions(const corpus_t *corpus,
+                                         sample_t *sample,
+                                         const writer_t *writer,
+                                         double minSeconds, bool csv)
+{
+  json_view_t root, array, item, next, items[PREDICT_RECORDS];
+  json_cursor_t cursor;
+  size_t lengths[PREDICT_RECORDS], count = 0;
+  if (corpus->columnKeys[0] == nullptr)
+    return FUNC_SUCCESS;
+  if (ViewJson(writer->str, writer->length, &root) != FUNC_SUCCESS ||
+      ViewGetField(root, corpus->arrayKey, &array) != FUNC_SUCCESS ||
+      ViewIterate(array, &cursor) != FUNC_SUCCESS)
+  {
+    return MEMORY_FAILURE;
+  }
+
+  // An item ends where the separator before the next one starts, and only
+  // items that fit the buffer are kept
+  size_t bytes = 0;
+  bool isNext = ViewNextItem(&cursor, &item) == FUNC_SUCCESS;
+  while (count < PREDICT_RECORDS && isNext &&
+         (isNext = ViewNextItem(&cursor, &next) == FUNC_SUCCESS))
+  {
+    const char *end = next.str;
+    while (end > item.str && strchr(", \t\r\n", end[-1]) != nullptr)
+      end--;
+    const size_t length = end - item.str;
+    if (length < JSONBUFFSIZE)
+    {
+      items[count] = item;
+      lengths[count++] = length;
+      bytes += length;
+    }
+    item = next;
+  }
+  if (count == 0)
+    return FUNC_SUCCESS;
+
+  json_parser_t *parser = malloc(sizeof(json_parser_t));
+  json_predictor_t *predictor = malloc(sizeof(json_predictor_t));
+  string_json_t *record = calloc(1, sizeof(string_json_t));
+  string_json_t *result = calloc(1, sizeof(string_json_t));
+  status_json_t status = MEMORY_FAILURE;
+  if (parser != nullptr && predictor != nullptr && record != nullptr &&
+      result != nullptr)
+  {
+    InitJsonParser(parser);
+    InitJsonPredictor(predictor);
+    status = FUNC_SUCCESS;
+
+    sample->function = "ParserGetProperty records";
+    sample->bytes = bytes;
+    MEASURE(*sample, minSeconds,
+            status |= LookUpRecords(corpus, items, lengths, count, parser,
+                                    nullptr, record, result));
+    PrintSample(sample, csv);
+
+    sample->function = "PredictedGetProperty";
+    MEASURE(*sample, minSeconds,
+            status |= LookUpRecords(corpus, items, lengths, count, parser,
+                                    predictor, record, result));
+    PrintSample(sample, csv);
+    if (!csv)
+    {
+      printf("%-8s %-9s %10zu  %.1f%% of the keys predicted\n", sample->corpus,
+             sample->format, sample->size,
+             100.0 * predictor->hits / (predictor->hits + predictor->misses));
+    }
+    FreeJsonParser(parser);
+  }
+
+  free(parser);
+  free(predictor);
+  if (record != nullptr)
+    FreeJsonString(record);
+  if (result != nullptr)
+    FreeJsonString(result);
+  free(record);
+  free(result);
+  return status;
+}
+
+// Keeps the array of the corpus, which is nearly all of the document, or else
+// only the last member, which skips nearly all of it. The memcpy of the kept
+// bytes is the bound the projection is measured against
+static status_json_t RunProjectFunctions(const corpus_t *corpus,
+                                         sample_t *sample,
+                                         const writer_t *writer,
+                                         double minSeconds, bool csv)
+{
+  const char *paths[] = {"count", corpus->arrayKey};
+  const size_t count = corpus->arrayKey != nullptr ? 2 : 1;
+  const size_t capacity = writer->length + 64;
+  char *output = malloc(capacity);
+  json_view_t root;
+  size_t length;
+  if (output == nullptr ||
+      ViewJson(writer->str, writer->length, &root) != FUNC_SUCCESS)
+  {
+    free(output);
+    return MEMORY_FAILURE;
+  }
+
+  status_json_t status = FUNC_SUCCESS;
+  sample->function = "ProjectJson";
+  sample->bytes = writer->length;
+  MEASURE(*sample, minSeconds,
+          status |= ProjectJson(root, paths, count, output, capacity, &length);
+          Consume(output));
+  PrintSample(sample, csv);
+
+  sample->function = "memcpy kept bytes";
+  MEASURE(*sample, minSeconds, memcpy(output, writer->str, length);
+          Consume(output));
+  PrintSample(sample, csv);
+
+  free(output);
+  return status;
+}
+
+// Finds the last member of an ingested document, which scans all of it
+static void ReadIngested(const char *, const char *content, size_t length,
+                         status_json_t status, void *data)
+{
+  json_view_t root, value;
+  double number;
+  if (status != FUNC_SUCCESS ||
+      ViewJson(content, length, &root) != FUNC_SUCCESS ||
+      ViewGetField(root, "count", &value) != FUNC_SUCCESS ||
+      ViewGetDouble(value, &number) != FUNC_SUCCESS)
+  {
+    *(_Atomic bool *)data = true;
+  }
+  Consume(&number);
+}
+
+// What IngestJsonFiles replaces: read a file, then parse it, one at a time
+static status_json_t IngestSerially(const char *const *paths, char *buffer,
+                                    size_t bufferSize, _Atomic bool *isFailed)
+{
+  for (size_t i = 0; i < INGEST_FILES; i++)
+  {
+    FILE *file = fopen(paths[i], "rb");
+    if (file == nullptr)
+    {
+      return UNSUPPORTED_OPERATION;
+    }
+    const size_t length = fread(buffer, 1, bufferSize - 1, file);
+    fclose(file);
+    buffer[length] = '\0';
+    ReadIngested(paths[i], buffer, length, FUNC_SUCCESS, isFailed);
+  }
+  return FUNC_SUCCESS;
+}
+
+// Writes copies of the document to disk and reads them back serially, then
+// through the pipeline with blocking reads and with io_uring. The files stay
+// in the page cache, so this measures how well reads and parsing overlap
+static status_json_t RunIngestFunctions(sample_t *sample,
+                                        const writer_t *writer,
+                                        double minSeconds, bool csv)
+{
+  char names[INGEST_FILES][sizeof(INGEST_PATH) + 24];
+  const char *paths[INGEST_FILES];
+  status_json_t status = FUNC_SUCCESS;
+  for (size_t i = 0; i < INGEST_FILES; i++)
+  {
+    snprintf(names[i], sizeof(names[i]), INGEST_PATH, i);
+    paths[i] = names[i];
+    FILE *file = fopen(paths[i], "wb");
+    if (file == nullptr ||
+        fwrite(writer->str, 1, writer->length, file) != writer->length)
+    {
+      status = MEMORY_FAILURE;
+    }
+    if (file != nullptr)
+    {
+      fclose(file);
+    }
+  }
+
+  const size_t bufferSize = writer->length + 1;
+  char *buffers = malloc(bufferSize * INGEST_BUFFERS);
+  _Atomic bool isFailed = false;
+  ingest_options_json_t options = {ReadIngested,   &isFailed,
+                                   buffers,        INGEST_BUFFERS,
+                                   bufferSize,     INGEST_WORKERS,
+                                   true,           0};
+  if (buffers == nullptr)
+  {
+    status = MEMORY_FAILURE;
+  }
+
+  sample->bytes = writer->length * INGEST_FILES;
+  if (status == FUNC_SUCCESS)
+  {
+    sample->function = "fread serially";
+    MEASURE(*sample, minSeconds,
+            status |= IngestSerially(paths, buffers, bufferSize, &isFailed));
+    PrintSample(sample, csv);
+
+    sample->function = "IngestJsonFiles blocking";
+    MEASURE(*sample, minSeconds,
+            status |= IngestJsonFiles(paths, INGEST_FILES, &options));
+    PrintSample(sample, csv);
+
+    options.isBlocking = false;
+    sample->function = "IngestJsonFiles";
+    MEASURE(*sample, minSeconds,
+            status |= IngestJsonFiles(paths, INGEST_FILES, &options));
+    PrintSample(sample, csv);
+  }
+
+  for (size_t i = 0; i < INGEST_FILES; i++)
+  {
+    remove(paths[i]);
+  }
+  free(buffers);
+  return isFailed ? UNSUPPORTED_OPERATION : status;
+}
+
+// Tapes are not limited to JSONBUFFSIZE, so these also cover the large sizes.
+// LoadJsonTape is the cold-start cost of a process reusing a saved tape
+static status_json_t RunTapeFunctions(sample_t *sample, const writer_t *writer,
+                                      double minSeconds, bool csv)
+{
+  size_t length;
+  status_json_t status =
+      ConvertJsonToTape(writer->str, writer->length, nullptr, 0, &length);
+  unsigned char *tape = malloc(length);
+  if (status != FUNC_SUCCESS || tape == nullptr)
+  {
+    free(tape);
+    return MEMORY_FAILURE;
+  }
+
+  sample->function = "ConvertJsonToTape";
+  sample->bytes = writer->length;
+  MEASURE(*sample, minSeconds,
+          status |= ConvertJsonToTape(writer->str, writer->length, tape,
+                                      length, &length);
+          Consume(tape));
+  PrintSample(sample, csv);
+
+  status |= SaveJsonTape(tape, length, TAPE_PATH);
+  free(tape);
+
+  tape_file_json_t file;
+  tape_json_t root, value;
+  sample->function = "LoadJsonTape";
+  sample->bytes = length;
+  MEASURE(*sample, minSeconds,
+          status |= LoadJsonTape(TAPE_PATH, &file, &root);
+          Consume(&root); UnloadJsonTape(&file));
+  PrintSample(sample, csv);
+
+  if ((status |= LoadJsonTape(TAPE_PATH, &file, &root)) != FUNC_SUCCESS)
+  {
+    remove(TAPE_PATH);
+    return status;
+  }
+
+  sample->function = "GetTapeProperty";
+  MEASURE(*sample, minSeconds,
+          status |= GetTapeProperty(root, &value, "count");
+          Consume(&value));
+  PrintSample(sample, csv);
+
+  double number = 0;
+  sample->function = "ConvertTapeToStandardType";
+  sample->bytes = sizeof(number);
+  MEASURE(*sample, minSeconds,
+          status |= ConvertTapeToStandardType(value, JSON_DOUBLE, &number);
+          Consume(&number));
+  PrintSample(sample, csv);
+
+  UnloadJsonTape(&file);
+  remove(TAPE_PATH);
+  return status;
+}
+
+static bool RunCorpus(const corpus_t *corpus, bool pretty, size_t size,
+                      double minSeconds, bool csv, string_json_t *json,
+                      string_json_t *result)
+{
+  sample_t sample = {
+      .corpus = corpus->name,
+      .format = pretty ? "pretty" : "minified",
+      .size = size,
+  };
+
+  writer_t writer = {.str = malloc(size + 1), .length = 0, .capacity = size};
+  if (writer.str == nullptr || !corpus->generate(&writer, pretty))
+  {
+    fprintf(stderr, "Failed to generate %s/%s/%zu\n", sample.corpus,
+            sample.format, size);
+    free(writer.str);
+    return false;
+  }
+
+  // Documents have to fit the string_json_t buffer
+  status_json_t status = FUNC_SUCCESS;
+  if (size < JSONBUFFSIZE)
+  {
+    status |= RunStringFunctions(corpus, &sample, &writer, minSeconds, csv,
+                                 json, result);
+  }
+  status |= RunViewFunctions(&sample, &writer, minSeconds, csv);
+  status |= RunEventFunctions(&sample, &writer, minSeconds, csv);
+  status |= RunColumnFunctions(corpus, &sample, &writer, minSeconds, csv);
+  status |= RunInternFunctions(corpus, &sample, &writer, minSeconds, csv);
+  status |= RunPredictFunctions(corpus, &sample, &writer, minSeconds, csv);
+  if (size <= MAX_PATCH_SIZE)
+  {
+    status |= RunPatchFunctions(&sample, &writer, minSeconds, csv);
+    status |= RunProjectFunctions(corpus, &sample, &writer, minSeconds, csv);
+  }
+  if (size <= MAX_INGEST_SIZE)
+  {
+    status |= RunIngestFunctions(&sample, &writer, minSeconds, csv);
+  }
+  status |= RunTapeFunctions(&sample, &writer, minSeconds, csv);
+
+  free(writer.str);
+  if (status != FUNC_SUCCESS)
+  {
+    fprintf(stderr, "%s/%s/%zu returned a failure status\n", sample.corpus,
+            sample.format, size);
+    return false;
+  }
+  return true;
+}
+
+int main(int argc, char **argv)
+{
+  bool csv = false;
+  double minSeconds = DEFAULT_MIN_SECONDS;
+  for (int i = 1; i < argc; i++)
+  {
+    if (strcmp(argv[i], "--csv") == 0)
+    {
+      csv = true;
+    }
+    else if (strcmp(argv[i], "--min-time") == 0 && i + 1 < argc)
+    {
+      minSeconds = strtod(argv[++i], nullptr);
+    }
+    else
+    {
+      fprintf(stderr, "Usage: %s [--csv] [--min-time seconds]\n", argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+
+  string_json_t *json = calloc(1, sizeof(string_json_t));
+  string_json_t *result = calloc(1, sizeof(string_json_t));
+  if (json == nullptr || result == nullptr)
+  {
+    return EXIT_FAILURE;
+  }
+
+  if (csv)
+  {
+    printf("profile,corpus,format,size,function,bytes,iterations,ns_per_op,"
+           "mb_per_s,allocs_per_op\n");
+  }
+  else
+  {
+    // Footprint of the fixed-size types, which the profile decides
+    printf("profile %s: string_json_t %zu B, array_json_t %zu B, "
+           "json_cache_t %zu B, json_parser_t %zu B\n",
+           PROFILE, sizeof(string_json_t), sizeof(array_json_t),
+           sizeof(json_cache_t), sizeof(json_parser_t));
+  }
+
+  bool passed = true;
+  for (size_t c = 0; c < COUNT_CORPORA; c++)
+  {
+    for (size_t f = 0; f < COUNT_FORMATS; f++)
+    {
+      for (size_t s = 0; s < COUNT_SIZES; s++)
+      {
+        if (SIZES[s] > MAX_TAPE_SOURCE_SIZE)
+        {
+          if (!csv)
+          {
+            printf("%-8s %-9s %10zu  skipped, larger than the tape limit\n",
+                   CORPORA[c].name, f ? "pretty" : "minified", SIZES[s]);
+          }
+          continue;
+        }
+        passed &= RunCorpus(&CORPORA[c], f == 1, SIZES[s], minSeconds, csv,
+                            json, result);
+      }
+    }
+  }
+
+  FreeJsonString(result);
+  FreeJsonString(json);
+  free(result);
+  free(json);
+  return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,1187 @@
+#define _POSIX_C_SOURCE 200809L
+#include <errno.h>
+#include <json.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Fuzzing entry point shared by libFuzzer and AFL. Every input is run through
+// GetJsonProperty3 (and with it FindValue), ProbeJsonSpan, CachedGetProperty,
+// PredictedGetProperty, InternJsonString, ConvertJsonToStandardType,
+// MapStringArray, the on-demand views, the event interface, DiffJson,
+// ApplyJsonMergePatch, ProjectJson and the binary tape encoder. When the input
+// is a valid JSON object the results are checked against the reference parser
+// below. Inputs that take longer than a linear time budget are reported as
+// failures so super-linear paths show up as crashes.
+
+constexpr size_t MAX_QUERIES = 16;
+constexpr size_t MAX_REFERENCE_DEPTH = JSONMAXDEPTH / 2;
+constexpr size_t MAX_ARRAY_ITEMS = 256;
+constexpr size_t MAX_VIEW_DEPTH = 64;
+constexpr size_t MAX_COLUMN_ROWS = 256;
+
+// Inputs are capped at the default buffer size, which every profile but the
+// tiny one can hold
+constexpr size_t MAX_INPUT_SIZE =
+    JSONBUFFSIZE < USHRT_MAX ? JSONBUFFSIZE : USHRT_MAX;
+
+// A tape node is at most 18 bytes per byte of input, a lone digit being the
+// worst case, plus the header
+constexpr size_t TAPE_CAPACITY = MAX_INPUT_SIZE * 18 + 16;
+
+// Budget per library call: a fixed cost, which also covers the by-value copy
+// of string_json_t, plus a cost per input byte. Both are generous enough to
+// absorb sanitizer overhead; JSON_FUZZ_BUDGET_SCALE scales them
+constexpr double BUDGET_BASE_NS = 2e6;
+constexpr double BUDGET_NS_PER_BYTE = 500;
+
+typedef struct
+{
+  size_t start;
+  size_t end; // Exclusive
+} span_t;
+
+typedef struct
+{
+  span_t key;   // Without the double quotes
+  span_t value; // Raw bytes of the value
+} member_t;
+
+typedef struct
+{
+  const char *str;
+  size_t length;
+  size_t pos;
+  member_t members[MAX_QUERIES];
+  size_t countMembers;
+} reference_t;
+
+static string_json_t json;
+static string_json_t result;
+static array_json_t array;
+static char text[MAX_INPUT_SIZE + 1];
+static char cResult[MAX_INPUT_SIZE];
+static char patched[MAX_INPUT_SIZE + 16];
+static size_t operations;
+static unsigned char tape[TAPE_CAPACITY];
+static json_cache_t cache;
+static json_intern_t intern;
+// Never reset, so that the layout learnt from one input is tried on the next
+static json_predictor_t predictor;
+static string_json_t cached;
+
+static void Fail(const char *message, const char *key)
+{
+  fprintf(stderr, "fuzz: %s (key \"%s\")\n", message, key ? key : "");
+  abort();
+}
+
+// Reference parser: a strict RFC 8259 validator that records the members of
+// every object in document order
+
+static void RefSkipWhitespace(reference_t *ref)
+{
+  while (ref->pos < ref->length &&
+         (ref->str[ref->pos] == ' ' || ref->str[ref->pos] == '\t' ||
+          ref->str[ref->pos] == '\n' || ref->str[ref->pos] == '\r'))
+  {
+    ref->pos++;
+  }
+}
+
+static bool RefIsHex(const char c)
+{
+  return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') ||
+         (c >= 'A' && c <= 'F');
+}
+
+static bool RefString(reference_t *ref, span_t *content)
+{
+  if (ref->pos >= ref->length || ref->str[ref->pos] != '"')
+  {
+    return false;
+  }
+  content->start = ++ref->pos;
+  while (ref->pos < ref->length)
+  {
+    const unsigned char c = ref->str[ref->pos];
+    if (c == '"')
+    {
+      content->end = ref->pos++;
+      return true;
+    }
+    if (c < 0x20)
+    {
+      return false;
+    }
+    if (c == '\\')
+    {
+      if (++ref->pos >= ref->length)
+      {
+        return false;
+      }
+      switch (ref->str[ref->pos])
+      {
+      case '"':
+      case '\\':
+      case '/':
+      case 'b':
+      case 'f':
+      case 'n':
+      case 'r':
+      case 't':
+        break;
+      case 'u':
+        for (int i = 0; i < 4; i++)
+        {
+          if (++ref->pos >= ref->length || !RefIsHex(ref->str[ref->pos]))
+          {
+            return false;
+          }
+        }
+        break;
+      default:
+        return false;
+      }
+    }
+    ref->pos++;
+  }
+  return false;
+}
+
+static bool RefDigits(reference_t *ref)
+{
+  const size_t start = ref->pos;
+  while (ref->pos < ref->length && ref->str[ref->pos] >= '0' &&
+         ref->str[ref->pos] <= '9')
+  {
+    ref->pos++;
+  }
+  return ref->pos > start;
+}
+
+static bool RefNumber(reference_t *ref)
+{
+  if (ref->pos < ref->length && ref->str[ref->pos] == '-')
+  {
+    ref->pos++;
+  }
+  if (ref->pos < ref->length && ref->str[ref->pos] == '0')
+  {
+    ref->pos++;
+  }
+  else if (!RefDigits(ref))
+  {
+    return false;
+  }
+  if (ref->pos < ref->length && ref->str[ref->pos] == '.')
+  {
+    ref->pos++;
+    if (!RefDigits(ref))
+    {
+      return false;
+    }
+  }
+  if (ref->pos < ref->length &&
+      (ref->str[ref->pos] == 'e' || ref->str[ref->pos] == 'E'))
+  {
+    ref->pos++;
+    if (ref->pos < ref->length &&
+        (ref->str[ref->pos] == '+' || ref->str[ref->pos] == '-'))
+    {
+      ref->pos++;
+    }
+    if (!RefDigits(ref))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+static bool RefLiteral(reference_t *ref, const char *literal)
+{
+  const size_t length = strlen(literal);
+  if (ref->length - ref->pos < length ||
+      memcmp(&ref->str[ref->pos], literal, length) != 0)
+  {
+    return false;
+  }
+  ref->pos += length;
+  return true;
+}
+
+static bool RefValue(reference_t *ref, size_t depth, span_t *value)
+{
+  if (depth > MAX_REFERENCE_DEPTH || ref->pos >= ref->length)
+  {
+    return false;
+  }
+
+  value->start = ref->pos;
+  bool valid = false;
+  span_t ignored;
+  switch (ref->str[ref->pos])
+  {
+  case '"':
+    valid = RefString(ref, &ignored);
+    break;
+  case 't':
+    valid = RefLiteral(ref, "true");
+    break;
+  case 'f':
+    valid = RefLiteral(ref, "false");
+    break;
+  case 'n':
+    valid = RefLiteral(ref, "null");
+    break;
+  case '[':
+    ref->pos++;
+    RefSkipWhitespace(ref);
+    if (ref->pos < ref->length && ref->str[ref->pos] == ']')
+    {
+      ref->pos++;
+      valid = true;
+      break;
+    }
+    while (true)
+    {
+      span_t item;
+      if (!RefValue(ref, depth + 1, &item))
+      {
+        return false;
+      }
+      RefSkipWhitespace(ref);
+      if (ref->pos < ref->length && ref->str[ref->pos] == ',')
+      {
+        ref->pos++;
+        RefSkipWhitespace(ref);
+        continue;
+      }
+      valid = ref->pos < ref->length && ref->str[ref->pos++] == ']';
+      break;
+    }
+    break;
+  case '{':
+    ref->pos++;
+    RefSkipWhitespace(ref);
+    if (ref->pos < ref->length && ref->str[ref->pos] == '}')
+    {
+      ref->pos++;
+      valid = true;
+      break;
+    }
+    while (true)
+    {
+      member_t member;
+      if (!RefString(ref, &member.key))
+      {
+        return false;
+      }
+      RefSkipWhitespace(ref);
+      if (ref->pos >= ref->length || ref->str[ref->pos++] != ':')
+      {
+        return false;
+      }
+      RefSkipWhitespace(ref);
+
+      // Members are recorded before their value is walked so that the list
+      // stays in document order
+      const size_t index = ref->countMembers;
+      if (index < MAX_QUERIES)
+      {
+        ref->countMembers++;
+      }
+      if (!RefValue(ref, depth + 1, &member.value))
+      {
+        return false;
+      }
+      if (index < MAX_QUERIES)
+      {
+        ref->members[index] = member;
+      }
+
+      RefSkipWhitespace(ref);
+      if (ref->pos < ref->length && ref->str[ref->pos] == ',')
+      {
+        ref->pos++;
+        RefSkipWhitespace(ref);
+        continue;
+      }
+      valid = ref->pos < ref->length && ref->str[ref->pos++] == '}';
+      break;
+    }
+    break;
+  default:
+    valid = RefNumber(ref);
+    break;
+  }
+
+  value->end = ref->pos;
+  return valid;
+}
+
+static bool RefDocument(reference_t *ref)
+{
+  span_t document;
+  RefSkipWhitespace(ref);
+  if (ref->pos >= ref->length || ref->str[ref->pos] != '{' ||
+      !RefValue(ref, 0, &document))
+  {
+    return false;
+  }
+  RefSkipWhitespace(ref);
+  return ref->pos == ref->length;
+}
+
+// The library hands strings back without their double quotes
+static span_t RefExpected(const reference_t *ref, span_t value)
+{
+  if (ref->str[value.start] == '"')
+  {
+    value.start++;
+    value.end--;
+  }
+  return value;
+}
+
+static bool SpanEquals(const reference_t *ref, span_t a, span_t b)
+{
+  return a.end - a.start == b.end - b.start &&
+         memcmp(&ref->str[a.start], &ref->str[b.start], a.end - a.start) == 0;
+}
+
+// Differential checks
+
+static void CheckNumber(const reference_t *ref, span_t value, const char *key)
+{
+  char reference[512];
+  const size_t length = value.end - value.start;
+  if (length >= sizeof(reference))
+  {
+    return;
+  }
+  memcpy(reference, &ref->str[value.start], length);
+  reference[length] = '\0';
+
+  // Literals that overflow are reported, with the value set like strtod does
+  double number = 0;
+  const double expected = strtod(reference, nullptr);
+  operations++;
+  if (ConvertJsonToStandardType(result, JSON_DOUBLE, &number) !=
+      (isinf(expected) ? NUMBER_OUT_OF_RANGE : FUNC_SUCCESS))
+  {
+    Fail("JSON_DOUBLE conversion failed on a valid number", key);
+  }
+  if (memcmp(&number, &expected, sizeof(double)) != 0 &&
+      !(isnan(number) && isnan(expected)))
+  {
+    Fail("JSON_DOUBLE differs from strtod", key);
+  }
+
+  // Integer literals are exact up to the full range of a long
+  if (strpbrk(reference, ".eE") != nullptr)
+  {
+    return;
+  }
+  long integer = 0;
+  errno = 0;
+  const long expectedInteger = strtol(reference, nullptr, 10);
+  const bool isOverflow = errno == ERANGE;
+  operations++;
+  if (ConvertJsonToStandardType(result, JSON_LONG, &integer) !=
+          (isOverflow ? NUMBER_OUT_OF_RANGE : FUNC_SUCCESS) ||
+      (!isOverflow && integer != expectedInteger))
+  {
+    Fail("JSON_LONG differs from strtol", key);
+  }
+}
+
+static void CountItem(char *item, size_t index, void *data)
+{
+  size_t *count = (size_t *)data;
+  if (index != *count)
+  {
+    Fail("MapStringArray skipped an index", item);
+  }
+  (*count)++;
+}
+
+// Arrays whose items are all strings, all objects or all arrays are fully
+// supported by MapStringArray, so the item count has to match
+static void CheckArray(const reference_t *ref, span_t value, const char *key)
+{
+  reference_t items = {.str = ref->str, .length = value.end - 1,
+                       .pos = value.start + 1};
+  size_t expected = 0;
+  char kind = 0;
+  bool isHomogeneous = true;
+  RefSkipWhitespace(&items);
+  while (items.pos < items.length && expected < MAX_ARRAY_ITEMS)
+  {
+    span_t item;
+    const char first = items.str[items.pos];
+    if (!RefValue(&items, 0, &item))
+    {
+      return;
+    }
+    if (kind == 0)
+    {
+      kind = first;
+    }
+    isHomogeneous &= first == kind && (first == '"' || first == '{' ||
+                                       first == '[');
+    expected++;
+    RefSkipWhitespace(&items);
+    if (items.pos < items.length && items.str[items.pos] == ',')
+    {
+      items.pos++;
+      RefSkipWhitespace(&items);
+    }
+  }
+
+  const size_t length = value.end - value.start;
+  memcpy(text, &ref->str[value.start], length);
+  text[length] = '\0';
+
+  size_t count = 0;
+  operations++;
+  MapStringArray(CountItem, text, &count, length);
+  if (isHomogeneous && expected < MAX_ARRAY_ITEMS && length > 3 &&
+      count != expected)
+  {
+    Fail("MapStringArray item count differs from the reference", key);
+  }
+}
+
+static void CheckMembers(const reference_t *ref)
+{
+  char key[MAX_INPUT_SIZE];
+  for (size_t m = 0; m < ref->countMembers; m++)
+  {
+    const member_t *member = &ref->members[m];
+    const size_t keyLength = member->key.end - member->key.start;
+    memcpy(key, &ref->str[member->key.start], keyLength);
+    key[keyLength] = '\0';
+
+    // The library returns the first member with that key in document order
+    size_t first = 0;
+    while (!SpanEquals(ref, ref->members[first].key, member->key))
+    {
+      first++;
+    }
+    if (first != m)
+    {
+      continue;
+    }
+
+    operations++;
+    if (GetJsonProperty3(json, &result, key) != FUNC_SUCCESS)
+    {
+      Fail("GetJsonProperty3 failed on an existing key", key);
+    }
+
+    const span_t expected = RefExpected(ref, member->value);
+    if (result.length != expected.end - expected.start ||
+        memcmp(result.str, &ref->str[expected.start], result.length) != 0)
+    {
+      Fail("GetJsonProperty3 differs from the reference", key);
+    }
+
+    // Periods would make the key a path
+    json_view_t probe;
+    operations++;
+    if (strchr(key, '.') == nullptr &&
+        (ProbeJsonSpan(&json, key, &probe) != FUNC_SUCCESS ||
+         probe.str != &json.str[member->value.start] ||
+         probe.length != member->value.end - member->value.start))
+    {
+      Fail("ProbeJsonSpan differs from the reference", key);
+    }
+
+    // Interning the key again must hand out the same copy
+    const char *interned, *again;
+    operations += 2;
+    if (InternJsonString(&intern, key, keyLength, &interned) == FUNC_SUCCESS &&
+        (InternJsonString(&intern, key, keyLength, &again) != FUNC_SUCCESS ||
+         again != interned || memcmp(interned, key, keyLength) != 0 ||
+         interned[keyLength] != '\0'))
+    {
+      Fail("InternJsonString handed out a different copy", key);
+    }
+
+    // First a miss that fills the cache, then a hit served from it
+    for (size_t pass = 0; pass < 2; pass++)
+    {
+      operations++;
+      if (CachedGetProperty(&cache, &json, &cached, key) != FUNC_SUCCESS ||
+          cached.length != result.length || cached.type != result.type ||
+          memcmp(cached.str, result.str, result.length) != 0)
+      {
+        Fail("CachedGetProperty differs from GetJsonProperty3", key);
+      }
+    }
+
+    switch (ref->str[member->value.start])
+    {
+    case '"':
+    case 't':
+    case 'f':
+    case 'n':
+      break;
+    case '[':
+      CheckArray(ref, member->value, key);
+      break;
+    case '{':
+      break;
+    default:
+      CheckNumber(ref, member->value, key);
+      break;
+    }
+  }
+
+  // Nothing in a valid document can match a key holding a control character
+  operations++;
+  if (GetJsonProperty3(json, &result, "\x01") != UNDEFINED_KEY)
+  {
+    Fail("GetJsonProperty3 found a key that does not exist", "\\x01");
+  }
+}
+
+// Every valid document must encode, and its members must come back from the
+// tape with the same type. Keys holding escapes are skipped since the tape
+// compares unescaped names
+static void CheckTape(const reference_t *ref)
+{
+  size_t length;
+  tape_json_t root, value;
+  operations++;
+  if (ConvertJsonToTape(ref->str, ref->length, tape, sizeof(tape), &length) !=
+          FUNC_SUCCESS ||
+      OpenJsonTape(tape, length, &root) != FUNC_SUCCESS)
+  {
+    Fail("ConvertJsonToTape rejected a valid document", nullptr);
+  }
+
+  char key[MAX_INPUT_SIZE];
+  for (size_t m = 0; m < ref->countMembers; m++)
+  {
+    const member_t *member = &ref->members[m];
+    const size_t keyLength = member->key.end - member->key.start;
+    memcpy(key, &ref->str[member->key.start], keyLength);
+    key[keyLength] = '\0';
+
+    size_t first = 0;
+    while (!SpanEquals(ref, ref->members[first].key, member->key))
+    {
+      first++;
+    }
+    if (first != m || memchr(key, '\\', keyLength) != nullptr ||
+        strlen(key) != keyLength)
+    {
+      continue;
+    }
+
+    operations++;
+    if (GetTapeProperty(root, &value, key) != FUNC_SUCCESS)
+    {
+      Fail("GetTapeProperty failed on an existing key", key);
+    }
+
+    type_json_t expected;
+    switch (ref->str[member->value.start])
+    {
+    case '"':
+      expected = JSTRING;
+      break;
+    case 't':
+    case 'f':
+      expected = JBOOLEAN;
+      break;
+    case 'n':
+      expected = JNULL;
+      break;
+    case '[':
+      expected = JARRAY;
+      break;
+    case '{':
+      expected = JOBJECT;
+      break;
+    default:
+      expected = JNUMBER;
+      break;
+    }
+    if (value.type != expected)
+    {
+      Fail("GetTapeProperty returned a different type", key);
+    }
+
+    const size_t numberLength = member->value.end - member->value.start;
+    if (expected == JNUMBER && numberLength < 512)
+    {
+      char reference[512];
+      double number;
+      memcpy(reference, &ref->str[member->value.start], numberLength);
+      reference[numberLength] = '\0';
+      ConvertTapeToStandardType(value, JSON_DOUBLE, &number);
+      const double decoded = strtod(reference, nullptr);
+      if (memcmp(&number, &decoded, sizeof(double)) != 0)
+      {
+        Fail("Tape number differs from strtod", key);
+      }
+    }
+  }
+}
+
+// Rows extracted from an array must match a lookup in every item. Arrays of
+// anything but objects with a numeric "a" member are allowed to fail
+static void CheckColumns(json_view_t array)
+{
+  double a[MAX_COLUMN_ROWS];
+  bool isPresent[MAX_COLUMN_ROWS];
+  const column_json_t column = {"a", JSON_DOUBLE, a, isPresent};
+  json_cursor_t cursor;
+  json_view_t item, value;
+  size_t rows;
+  operations++;
+  if (ExtractJsonColumns(array, &column, 1, MAX_COLUMN_ROWS, &rows) !=
+          FUNC_SUCCESS ||
+      ViewIterate(array, &cursor) != FUNC_SUCCESS)
+  {
+    return;
+  }
+
+  size_t row = 0;
+  for (; ViewNextItem(&cursor, &item) == FUNC_SUCCESS; row++)
+  {
+    double expected = 0;
+    const bool isExpected = ViewGetField(item, "a", &value) == FUNC_SUCCESS &&
+                            value.type != JNULL;
+    if (isExpected)
+    {
+      ViewGetDouble(value, &expected);
+    }
+    if (row >= rows || isPresent[row] != isExpected ||
+        memcmp(&a[row], &expected, sizeof(double)) != 0)
+    {
+      Fail("ExtractJsonColumns differs from ViewGetField", "a");
+    }
+  }
+  if (row != rows)
+  {
+    Fail("ExtractJsonColumns miscounted the rows", nullptr);
+  }
+}
+
+// Touches every value through the on-demand API. Returns false if a cursor or
+// a getter rejected a value. Columns are only compared in valid documents,
+// since a malformed item can end in different places for a member cursor and
+// for a skip
+static bool WalkView(json_view_t view, size_t depth, bool isValid)
+{
+  json_cursor_t cursor;
+  json_view_t key, value;
+  status_json_t status;
+  const char *str;
+  size_t length;
+  double number;
+  long integer;
+  bool flag;
+
+  operations++;
+  switch (view.type)
+  {
+  case JOBJECT:
+  case JARRAY:
+    if (depth >= MAX_VIEW_DEPTH)
+    {
+      return true;
+    }
+    if (ViewIterate(view, &cursor) != FUNC_SUCCESS)
+    {
+      return false;
+    }
+    if (isValid && view.type == JARRAY)
+    {
+      CheckColumns(view);
+    }
+    while ((status = view.type == JOBJECT
+                         ? ViewNextField(&cursor, &key, &value)
+                         : ViewNextItem(&cursor, &value)) == FUNC_SUCCESS)
+    {
+      if (!WalkView(value, depth + 1, isValid))
+      {
+        return false;
+      }
+    }
+    return status == UNDEFINED_KEY;
+  case JSTRING:
+    return ViewGetString(view, &str, &length) == FUNC_SUCCESS;
+  case JNUMBER:
+    ViewGetLong(view, &integer);
+    return ViewGetDouble(view, &number) != UNSUPPORTED_OPERATION;
+  case JBOOLEAN:
+    return ViewGetBoolean(view, &flag) == FUNC_SUCCESS;
+  default:
+    return true;
+  }
+}
+
+// Every value of a valid document must be readable, and the first member is
+// always a direct member of the root
+static void CheckView(const reference_t *ref)
+{
+  json_view_t root, value;
+  if (ViewJson(ref->str, ref->length, &root) != FUNC_SUCCESS ||
+      !WalkView(root, 0, true))
+  {
+    Fail("On-demand walk rejected a valid document", nullptr);
+  }
+  if (ref->countMembers == 0)
+  {
+    return;
+  }
+
+  char key[MAX_INPUT_SIZE];
+  const member_t *member = &ref->members[0];
+  const size_t keyLength = member->key.end - member->key.start;
+  memcpy(key, &ref->str[member->key.start], keyLength);
+  key[keyLength] = '\0';
+
+  operations++;
+  if (strlen(key) == keyLength &&
+      (ViewGetField(root, key, &value) != FUNC_SUCCESS ||
+       value.str != &ref->str[member->value.start]))
+  {
+    Fail("ViewGetField differs from the reference", key);
+  }
+}
+
+// Keys and values reported by the event interface must be the members the
+// reference found, in the same document order and at the same addresses
+
+typedef struct
+{
+  const reference_t *ref;
+  size_t countKeys;
+  bool isValuePending;
+  size_t countOpen;
+} event_check_t;
+
+static bool CheckEventKey(json_view_t view, size_t, void *data)
+{
+  event_check_t *check = (event_check_t *)data;
+  const reference_t *ref = check->ref;
+  if (check->countKeys < ref->countMembers)
+  {
+    const span_t key = ref->members[check->countKeys].key;
+    if (view.str + 1 != &ref->str[key.start] ||
+        view.length - 2 != key.end - key.start)
+    {
+      Fail("Event key differs from the reference", nullptr);
+    }
+  }
+  check->countKeys++;
+  check->isValuePending = true;
+  return true;
+}
+
+static bool CheckEventValue(json_view_t view, size_t, void *data)
+{
+  event_check_t *check = (event_check_t *)data;
+  const reference_t *ref = check->ref;
+  if (check->isValuePending && check->countKeys <= ref->countMembers)
+  {
+    const span_t value = ref->members[check->countKeys - 1].value;
+    const bool isContainer = view.type == JOBJECT || view.type == JARRAY;
+    if (view.str != &ref->str[value.start] ||
+        (!isContainer && view.length != value.end - value.start))
+    {
+      Fail("Event value differs from the reference", nullptr);
+    }
+  }
+  check->isValuePending = false;
+  return true;
+}
+
+static bool CheckEventStart(json_view_t view, size_t depth, void *data)
+{
+  event_check_t *check = (event_check_t *)data;
+  if (depth != check->countOpen++)
+  {
+    Fail("Event depth differs from the nesting", nullptr);
+  }
+  return CheckEventValue(view, depth, data);
+}
+
+static bool CheckEventEnd(json_view_t, size_t depth, void *data)
+{
+  event_check_t *check = (event_check_t *)data;
+  if (check->countOpen == 0 || depth != --check->countOpen)
+  {
+    Fail("Event depth differs from the nesting", nullptr);
+  }
+  return true;
+}
+
+static void CheckEvents(const reference_t *ref)
+{
+  event_check_t check = {ref, 0, false, 0};
+  const event_handler_json_t handler = {
+      CheckEventStart, CheckEventEnd,   CheckEventStart,
+      CheckEventEnd,   CheckEventKey,   CheckEventValue,
+      CheckEventValue, CheckEventValue, CheckEventValue,
+      &check,
+  };
+  operations++;
+  if (ParseJsonEvents(ref->str, ref->length, &handler) != FUNC_SUCCESS ||
+      check.countOpen != 0)
+  {
+    Fail("Event interface rejected a valid document", nullptr);
+  }
+}
+
+// Merging an empty patch keeps every member, so the result must diff as
+// identical to the document; Removing the first key must remove every member
+// with that key. Patches stay small so that the lookups stay linear
+static void CheckPatch(const reference_t *ref)
+{
+  json_view_t root, patch, merged, value;
+  size_t length, patchLength;
+  char key[MAX_INPUT_SIZE], cPatch[MAX_INPUT_SIZE + 16];
+  if (ViewJson(ref->str, ref->length, &root) != FUNC_SUCCESS ||
+      root.type != JOBJECT)
+  {
+    return;
+  }
+
+  operations += 3;
+  if (DiffJson(root, root, cPatch, sizeof(cPatch), &patchLength) !=
+          FUNC_SUCCESS ||
+      strcmp(cPatch, "{}") != 0)
+  {
+    Fail("DiffJson found changes in an identical document", nullptr);
+  }
+  ViewJson(cPatch, patchLength, &patch);
+  if (ApplyJsonMergePatch(root, patch, patched, sizeof(patched), &length) !=
+          FUNC_SUCCESS ||
+      ViewJson(patched, length, &merged) != FUNC_SUCCESS ||
+      DiffJson(root, merged, cPatch, sizeof(cPatch), &patchLength) !=
+          FUNC_SUCCESS ||
+      strcmp(cPatch, "{}") != 0)
+  {
+    Fail("Merging an empty patch changed the document", nullptr);
+  }
+
+  if (ref->countMembers == 0)
+  {
+    return;
+  }
+  const member_t *member = &ref->members[0];
+  const size_t keyLength = member->key.end - member->key.start;
+  memcpy(key, &ref->str[member->key.start], keyLength);
+  key[keyLength] = '\0';
+  patchLength = snprintf(cPatch, sizeof(cPatch), "{\"%s\": null}", key);
+
+  operations += 2;
+  if (strlen(key) == keyLength &&
+      (ViewJson(cPatch, patchLength, &patch) != FUNC_SUCCESS ||
+       ApplyJsonMergePatch(root, patch, patched, sizeof(patched), &length) !=
+           FUNC_SUCCESS ||
+       ViewJson(patched, length, &merged) != FUNC_SUCCESS ||
+       ViewGetField(merged, key, &value) != UNDEFINED_KEY))
+  {
+    Fail("Merge patch did not remove the member", key);
+  }
+}
+
+// Projecting on the first key must keep its first value as written, and
+// projecting the projection again must not change it
+static void CheckProject(const reference_t *ref)
+{
+  json_view_t root, projected, value;
+  size_t length, againLength;
+  char key[MAX_INPUT_SIZE], again[MAX_INPUT_SIZE + 16];
+  if (ref->countMembers == 0 ||
+      ViewJson(ref->str, ref->length, &root) != FUNC_SUCCESS ||
+      root.type != JOBJECT)
+  {
+    return;
+  }
+
+  // Periods would make the key a path
+  const member_t *member = &ref->members[0];
+  const size_t keyLength = member->key.end - member->key.start;
+  const size_t valueLength = member->value.end - member->value.start;
+  memcpy(key, &ref->str[member->key.start], keyLength);
+  key[keyLength] = '\0';
+  if (strlen(key) != keyLength || strchr(key, '.') != nullptr)
+  {
+    return;
+  }
+
+  const char *paths[] = {key};
+  operations += 3;
+  if (ProjectJson(root, paths, 1, patched, sizeof(patched), &length) !=
+          FUNC_SUCCESS ||
+      ViewJson(patched, length, &projected) != FUNC_SUCCESS ||
+      ViewGetField(projected, key, &value) != FUNC_SUCCESS ||
+      value.length <= valueLength ||
+      memcmp(value.str, &ref->str[member->value.start], valueLength) != 0 ||
+      (value.str[valueLength] != ',' && value.str[valueLength] != '}'))
+  {
+    Fail("ProjectJson differs from the reference", key);
+  }
+  if (ProjectJson(projected, paths, 1, again, sizeof(again), &againLength) !=
+          FUNC_SUCCESS ||
+      againLength != length || memcmp(again, patched, length) != 0)
+  {
+    Fail("Projecting a projection changed it", key);
+  }
+}
+
+// A key that appears once can only be predicted at its one place, so twice
+// over, the second time at the offsets learnt the first time, every such key
+// must give what GetJsonProperty3 gives. Keys are only known to be unique when
+// every member was recorded
+static void CheckPredict(const reference_t *ref)
+{
+  char key[MAX_INPUT_SIZE];
+  if (ref->countMembers >= MAX_QUERIES)
+  {
+    return;
+  }
+
+  for (size_t pass = 0; pass < 2; pass++)
+  {
+    for (size_t m = 0; m < ref->countMembers; m++)
+    {
+      const member_t *member = &ref->members[m];
+      size_t occurrences = 0;
+      for (size_t other = 0; other < ref->countMembers; other++)
+      {
+        occurrences += SpanEquals(ref, ref->members[other].key, member->key);
+      }
+      const size_t keyLength = member->key.end - member->key.start;
+      memcpy(key, &ref->str[member->key.start], keyLength);
+      key[keyLength] = '\0';
+      if (occurrences > 1 || strlen(key) != keyLength)
+      {
+        continue;
+      }
+
+      operations += 2;
+      if (GetJsonProperty3(json, &result, key) != FUNC_SUCCESS ||
+          PredictedGetProperty(&predictor, &json, &cached, key) !=
+              FUNC_SUCCESS ||
+          cached.length != result.length || cached.type != result.type ||
+          memcmp(cached.str, result.str, result.length) != 0)
+      {
+        Fail("PredictedGetProperty differs from GetJsonProperty3", key);
+      }
+    }
+  }
+}
+
+// Crash-only coverage for inputs the reference parser rejects
+
+static void IgnoreItem(char *, size_t, void *) {}
+
+static bool IgnoreEvent(json_view_t, size_t, void *) { return true; }
+
+static void RunUnchecked(const uint8_t *data, size_t size)
+{
+  static const native_json_type_t TYPES[] = {
+      JSON_DOUBLE,     JSON_INT,       JSON_LONG,    JSON_CHAR_ARR,
+      JSON_DOUBLE_ARR, JSON_LONG_ARR,  JSON_INT_ARR, JSON_BOOLEAN,
+  };
+
+  const char *keys[] = {"a", "", text};
+  const size_t keyLength = size < 8 ? size : 8;
+  memcpy(text, data, keyLength);
+  text[keyLength] = '\0';
+  json_view_t probe;
+  for (size_t k = 0; k < sizeof(keys) / sizeof(keys[0]); k++)
+  {
+    operations += 2;
+    GetJsonProperty3(json, &result, keys[k]);
+    ProbeJsonSpan(&json, keys[k], &probe);
+    operations++;
+    PredictedGetProperty(&predictor, &json, &cached, keys[k]);
+  }
+
+  // Scalars get a destination of their own, since the dynamic profile keeps
+  // a pointer where the fixed ones keep the first item
+  union
+  {
+    double d;
+    long l;
+    int i;
+    bool b;
+  } scalar;
+  for (size_t t = 0; t < sizeof(TYPES) / sizeof(TYPES[0]); t++)
+  {
+    operations++;
+    switch (TYPES[t])
+    {
+    case JSON_CHAR_ARR:
+      ConvertJsonToStandardType(json, TYPES[t], cResult);
+      break;
+    case JSON_DOUBLE_ARR:
+    case JSON_LONG_ARR:
+    case JSON_INT_ARR:
+      ConvertJsonToStandardType(json, TYPES[t], &array);
+      break;
+    default:
+      ConvertJsonToStandardType(json, TYPES[t], &scalar);
+      break;
+    }
+  }
+
+  memcpy(text, data, size);
+  text[size] = '\0';
+  operations++;
+  MapStringArray(IgnoreItem, text, nullptr, size);
+
+  json_view_t view, patch;
+  if (ViewJson(json.str, size, &view) == FUNC_SUCCESS)
+  {
+    WalkView(view, 0, false);
+
+    size_t length;
+    operations += 2;
+    DiffJson(view, view, patched, sizeof(patched), &length);
+    ViewJson("{\"a\": null, \"b\": {}}", 20, &patch);
+    ApplyJsonMergePatch(view, patch, patched, sizeof(patched), &length);
+
+    const char *paths[] = {"a", "a.b", text};
+    operations++;
+    ProjectJson(view, paths, 3, patched, sizeof(patched), &length);
+  }
+
+  const event_handler_json_t handler = {
+      IgnoreEvent, IgnoreEvent, IgnoreEvent, IgnoreEvent, IgnoreEvent,
+      IgnoreEvent, IgnoreEvent, IgnoreEvent, IgnoreEvent, nullptr,
+  };
+  operations++;
+  ParseJsonEvents(json.str, size, &handler);
+
+  size_t length;
+  tape_json_t root, value;
+  operations++;
+  if (ConvertJsonToTape(json.str, size, tape, sizeof(tape), &length) ==
+          FUNC_SUCCESS &&
+      OpenJsonTape(tape, length, &root) == FUNC_SUCCESS)
+  {
+    for (size_t k = 0; k < sizeof(keys) / sizeof(keys[0]); k++)
+    {
+      operations++;
+      if (GetTapeProperty(root, &value, keys[k]) == FUNC_SUCCESS)
+      {
+        ConvertTapeToStandardType(value, JSON_CHAR_ARR, cResult);
+      }
+    }
+  }
+}
+
+static double GetNanoseconds()
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (double)now.tv_sec * 1e9 + (double)now.tv_nsec;
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+  if (size >= MAX_INPUT_SIZE || ReserveJsonString(&json, size) != FUNC_SUCCESS)
+  {
+    return 0;
+  }
+
+  static double budgetScale = 0;
+  if (budgetScale == 0)
+  {
+    const char *scale = getenv("JSON_FUZZ_BUDGET_SCALE");
+    budgetScale = scale != nullptr ? strtod(scale, nullptr) : 1;
+  }
+
+  memcpy(json.str, data, size);
+  json.length = size;
+  json.type = JUNDEFINED;
+  // The same buffer is rewritten for every input
+  InvalidateJsonCache(&cache);
+  InitJsonIntern(&intern);
+  operations = 0;
+
+  const double startTime = GetNanoseconds();
+  RunUnchecked(data, size);
+
+  reference_t ref = {.str = json.str, .length = size};
+  if (RefDocument(&ref))
+  {
+    CheckMembers(&ref);
+    CheckTape(&ref);
+    CheckView(&ref);
+    CheckEvents(&ref);
+    CheckPatch(&ref);
+    CheckProject(&ref);
+    CheckPredict(&ref);
+  }
+
+  const double elapsed = GetNanoseconds() - startTime;
+  const double budget =
+      operations * (BUDGET_BASE_NS + BUDGET_NS_PER_BYTE * size) * budgetScale;
+  if (elapsed > budget)
+  {
+    fprintf(stderr, "fuzz: %zu bytes took %.0f ns, over the %.0f ns budget\n",
+            size, elapsed, budget);
+    abort();
+  }
+  return 0;
+}
+
+#ifndef JSON_LIBFUZZER
+// Standalone driver for AFL and for replaying a corpus: every argument is an
+// input file, stdin is read when there are none
+static int RunFile(FILE *file, const char *name)
+{
+  static uint8_t input[MAX_INPUT_SIZE];
+  const size_t size = fread(input, 1, sizeof(input), file);
+  if (ferror(file))
+  {
+    fprintf(stderr, "fuzz: failed to read %s\n", name);
+    return EXIT_FAILURE;
+  }
+  LLVMFuzzerTestOneInput(input, size);
+  return EXIT_SUCCESS;
+}
+
+int main(int argc, char **argv)
+{
+  if (argc < 2)
+  {
+    return RunFile(stdin, "stdin");
+  }
+
+  for (int i = 1; i < argc; i++)
+  {
+    FILE *file = fopen(argv[i], "rb");
+    if (file == nullptr)
+    {
+      fprintf(stderr, "fuzz: failed to open %s\n", argv[i]);
+      return EXIT_FAILURE;
+    }
+    const int status = RunFile(file, argv[i]);
+    fclose(file);
+    if (status != EXIT_SUCCESS)
+    {
+      return status;
+    }
+  }
+  printf("fuzz: replayed %d inputs\n", argc - 1);
+  return EXIT_SUCCESS;
+}
+#endif
@@ -3,6 +3,7 @@
 
 #include <limits.h>
 #include <stddef.h>
+#include <stdint.h>
 
 #define GETPROP2(a, b) GetJsonProperty2(a, b)
 #define GETPROP3(a, b, c) GetJsonProperty3(a, b, c)
@@ -11,13 +12,57 @@
 #define GetProperty(...)                                                       \
   EXPAND(GET_PROP_MACRO(__VA_ARGS__, GETPROP3, GETPROP2)(__VA_ARGS__))
 
+// Size profiles, picked at build time with DEFINES=-DJSON_PROFILE_TINY,
+// -DJSON_PROFILE_LARGE or -DJSON_PROFILE_DYNAMIC. JSONBUFFSIZE bounds
+// string_json_t, array_json_t and the scratch buffers, and offset_json_t is
+// the smallest type that holds an offset into such a buffer. The dynamic
+// profile has no bound and keeps those buffers on the heap. JSONINTERNSIZE and
+// JSONINTERNBYTES size the slots and the storage of an interning table
+#if defined(JSON_PROFILE_TINY)
+constexpr unsigned short JSONBUFFSIZE = 1024;
+constexpr unsigned short JSONCACHESIZE = 16;
+constexpr unsigned short JSONCACHEKEYSIZE = 32;
+constexpr unsigned short JSONMAXDEPTH = 128;
+constexpr unsigned short JSONINTERNSIZE = 64;
+constexpr unsigned short JSONINTERNBYTES = 1024;
+typedef unsigned short offset_json_t;
+#elif defined(JSON_PROFILE_LARGE)
+constexpr unsigned int JSONBUFFSIZE = 1 << 20;
+constexpr unsigned short JSONCACHESIZE = 256;
+constexpr unsigned short JSONCACHEKEYSIZE = 64;
+constexpr unsigned short JSONMAXDEPTH = 1024;
+constexpr unsigned short JSONINTERNSIZE = 16384;
+constexpr unsigned int JSONINTERNBYTES = 1 << 20;
+typedef unsigned int offset_json_t;
+#elif defined(JSON_PROFILE_DYNAMIC)
+constexpr size_t JSONBUFFSIZE = SIZE_MAX;
+constexpr unsigned short JSONCACHESIZE = 64;
+constexpr unsigned short JSONCACHEKEYSIZE = 64;
+constexpr unsigned short JSONMAXDEPTH = 1024;
+constexpr unsigned short JSONINTERNSIZE = 16384;
+constexpr unsigned int JSONINTERNBYTES = 1 << 20;
+typedef size_t offset_json_t;
+#else
 constexpr unsigned short JSONBUFFSIZE = USHRT_MAX;
+constexpr unsigned short JSONCACHESIZE = 64;
+constexpr unsigned short JSONCACHEKEYSIZE = 64;
+constexpr unsigned short JSONMAXDEPTH = 1024;
+constexpr unsigned short JSONINTERNSIZE = 1024;
+constexpr unsigned short JSONINTERNBYTES = USHRT_MAX;
+typedef unsigned short offset_json_t;
+#endif
+constexpr unsigned short JSONMAXCOLUMNS = 64;
+constexpr unsigned short JSONMAXPATHS = 64;
+constexpr unsigned short JSONMAXWORKERS = 64;
+constexpr unsigned short JSONMAXBUFFERS = 128;
 typedef enum : short
 {
   MEMORY_FAILURE = -1,
   FUNC_SUCCESS = 0,
   UNSUPPORTED_OPERATION = 1,
-  UNDEFINED_KEY = 2
+  UNDEFINED_KEY = 2,
+  INVALID_NUMBER = 3,
+  NUMBER_OUT_OF_RANGE = 4
 } status_json_t;
 typedef enum : char
 {
@@ -50,10 +95,41 @@ typedef enum : unsigned char
   COLON = ':',
   COMMA = ',',
   PERIOD = '.',
+  MINUS = '-',
+  PLUS = '+',
   BACKSLASH = '\\',
   SPACE = ' ',
+  TAB = '\t',
+  NEWLINE = '\n',
+  CARRIAGE_RETURN = '\r',
 } token_json_t;
 
+#ifdef JSON_PROFILE_DYNAMIC
+// Zero-initialise before first use and release with FreeJsonString. Copies
+// share the buffer
+typedef struct
+{
+  size_t length;
+  char *str;
+  size_t capacity;
+  type_json_t type;
+} string_json_t;
+
+typedef union
+{
+  double *d;
+  long *l;
+  int *i;
+} array_data_t;
+
+// Zero-initialise before first use and release with FreeJsonArray
+typedef struct
+{
+  array_data_t data;
+  int length;
+  size_t capacity;
+} array_json_t;
+#else
 typedef struct
 {
   size_t length;
@@ -73,6 +149,193 @@ typedef struct
   array_data_t data;
   int length;
 } array_json_t;
+#endif
+
+typedef struct
+{
+  string_json_t scratch;
+  // Deepest nesting a lookup accepts before giving up; At most JSONMAXDEPTH
+  size_t maxDepth;
+} json_parser_t;
+
+typedef struct
+{
+  const char *str;
+  size_t length;
+  type_json_t type;
+} json_view_t;
+
+typedef struct
+{
+  const char *str;
+  size_t length;
+  size_t position;
+  type_json_t type;
+  bool isPending;
+} json_cursor_t;
+
+typedef struct
+{
+  // Member to extract from every object
+  const char *key;
+  // JSON_DOUBLE, JSON_LONG, JSON_INT or JSON_BOOLEAN
+  native_json_type_t type;
+  // Contiguous array of the matching C type, one element per row
+  void *data;
+  // Optional, one flag per row telling whether the member was present
+  bool *isPresent;
+} column_json_t;
+
+typedef struct
+{
+  char key[JSONCACHEKEYSIZE];
+  unsigned long long keyHash;
+  // Index of the opening quotes of the key
+  offset_json_t offset;
+  bool isUsed;
+} cache_entry_json_t;
+
+typedef struct
+{
+  const string_json_t *document;
+  size_t documentLength;
+  unsigned long long documentHash;
+  unsigned long long hits;
+  unsigned long long misses;
+  unsigned long long invalidations;
+  cache_entry_json_t entries[JSONCACHESIZE];
+} json_cache_t;
+
+typedef struct
+{
+  char key[JSONCACHEKEYSIZE];
+  unsigned long long keyHash;
+  // Index of the opening quotes of the key where it was last found
+  offset_json_t offset;
+  // Position of the lookup among the lookups of its record
+  size_t ordinal;
+  // Whether the key came right after the value of the lookup before it
+  bool isAdjacent;
+  // Record the key was last looked up in
+  unsigned long long record;
+  bool isUsed;
+} prediction_entry_json_t;
+
+typedef struct
+{
+  const string_json_t *document;
+  size_t documentLength;
+  unsigned long long records;
+  // Lookups so far in the current record
+  size_t ordinal;
+  // Index just past the value found by the last lookup
+  size_t end;
+  unsigned long long hits;
+  unsigned long long misses;
+  prediction_entry_json_t entries[JSONCACHESIZE];
+} json_predictor_t;
+
+typedef struct
+{
+  unsigned long long calls;
+  unsigned long long cycles;
+} call_stats_json_t;
+
+typedef struct
+{
+  unsigned long long hash;
+  offset_json_t offset;
+  // Zero for a free slot
+  offset_json_t length;
+} intern_entry_json_t;
+
+typedef struct
+{
+  size_t count;
+  size_t used;
+  unsigned long long hits;
+  unsigned long long misses;
+  intern_entry_json_t entries[JSONINTERNSIZE];
+  // Every interned string, each followed by a null terminator
+  char storage[JSONINTERNBYTES];
+} json_intern_t;
+
+typedef struct
+{
+  call_stats_json_t getProperty;
+  call_stats_json_t getValue;
+  call_stats_json_t convertToString;
+  call_stats_json_t convertStringToJson;
+  call_stats_json_t convertToStandardType;
+  call_stats_json_t mapStringArray;
+  unsigned long long bytesScanned;
+  unsigned long long keysCompared;
+  unsigned long long bytesCopied;
+  unsigned long long keysPredicted;
+  unsigned long long keysMispredicted;
+} stats_json_t;
+
+typedef struct
+{
+  const unsigned char *tape;
+  size_t length;
+  size_t offset;
+  type_json_t type;
+} tape_json_t;
+
+typedef struct
+{
+  void *mapping;
+  size_t size;
+} tape_file_json_t;
+
+typedef void (*profile_hook_json_t)(const char *function,
+                                    unsigned long long cycles, void *data);
+
+typedef bool (*event_callback_json_t)(json_view_t view, size_t depth,
+                                      void *data);
+
+typedef struct
+{
+  // Any callback may be nullptr to ignore its events. Returning false stops
+  // the parse
+  event_callback_json_t onStartObject;
+  event_callback_json_t onEndObject;
+  event_callback_json_t onStartArray;
+  event_callback_json_t onEndArray;
+  event_callback_json_t onKey;
+  event_callback_json_t onString;
+  event_callback_json_t onNumber;
+  event_callback_json_t onBoolean;
+  event_callback_json_t onNull;
+  // Passed to every callback
+  void *data;
+} event_handler_json_t;
+
+typedef void (*ingest_callback_json_t)(const char *path, const char *content,
+                                       size_t length, status_json_t status,
+                                       void *data);
+
+typedef struct
+{
+  // Runs on a worker thread for every path, in no particular order
+  ingest_callback_json_t callback;
+  // Passed to the callback
+  void *data;
+  // countBuffers * bufferSize bytes, owned by the caller
+  char *buffers;
+  // Files read ahead of the workers, at most JSONMAXBUFFERS
+  size_t countBuffers;
+  // Largest file plus one byte for the terminating NUL
+  size_t bufferSize;
+  // Worker threads running the callback, at most JSONMAXWORKERS
+  size_t countWorkers;
+  // Uses blocking reads even where io_uring is available
+  bool isBlocking;
+  // Threads doing blocking reads, calling thread included, at most
+  // JSONMAXWORKERS; 0 starts one per buffer
+  size_t countReaders;
+} ingest_options_json_t;
 
 /**
  * @brief Converts a json string to a standard c-string
@@ -90,6 +353,29 @@ status_json_t ConvertJsonToString(string_json_t src, char *dest);
  */
 status_json_t ConvertStringToJson(const char *src, string_json_t *dest);
 
+/**
+ * @brief Makes room in a JSON String for length bytes plus a terminating NUL,
+ * keeping its content. Only the dynamic profile allocates
+ * @param json String to grow
+ * @param length Bytes needed, excluding the terminating NUL
+ * @returns MEMORY_FAILURE if the string cannot hold length bytes
+ */
+status_json_t ReserveJsonString(string_json_t *json, size_t length);
+
+/**
+ * @brief Releases the buffer of a JSON String and empties it. Does nothing
+ * but empty it in the fixed-size profiles
+ * @param json String to release
+ */
+void FreeJsonString(string_json_t *json);
+
+/**
+ * @brief Releases the items of an array filled by a conversion and empties
+ * it. Does nothing but empty it in the fixed-size profiles
+ * @param array Array to release
+ */
+void FreeJsonArray(array_json_t *array);
+
 /**
  * @brief Gets a property from a JSON object by the field name
  * @param src JSON object containing the key-value we want to get
@@ -109,6 +395,33 @@ status_json_t GetJsonProperty3(string_json_t src, string_json_t *dest,
  */
 status_json_t GetJsonProperty2(string_json_t *srcDest, const char *target);
 
+/**
+ * @brief Checks whether a property exists and gets the type of its value
+ * without copying it. Scanning stops at the first byte of the value, however
+ * large the value is
+ * @param src JSON object to search
+ * @param path Name of the field, found as GetProperty would. Names separated
+ * by periods are looked up among the members of the value of the previous one,
+ * as in "a.b"; Unlike in ProjectJson, the first name may be at any depth
+ * @param dest Optional destination view of the value, whose type is set and
+ * whose length runs to the end of the document
+ * @returns UNDEFINED_KEY if any field along the path does not exist
+ */
+status_json_t ProbeJsonProperty(const string_json_t *src, const char *path,
+                                json_view_t *dest);
+
+/**
+ * @brief Gets the raw bytes of a property value without copying them. Unlike
+ * ProbeJsonProperty, the value is scanned to its end
+ * @param src JSON object to search
+ * @param path Name of the field or path of names, as in ProbeJsonProperty
+ * @param dest Destination view covering exactly the value, including the
+ * double quotes of strings
+ * @returns UNDEFINED_KEY if any field along the path does not exist
+ */
+status_json_t ProbeJsonSpan(const string_json_t *src, const char *path,
+                            json_view_t *dest);
+
 /**
  * @brief Gets a description of the error message thrown
  * @param status Status of the message to get the description from
@@ -116,11 +429,44 @@ status_json_t GetJsonProperty2(string_json_t *srcDest, const char *target);
  */
 void GetStatusErrorMessage(status_json_t status, char *dest);
 
+/**
+ * @brief Parses a number literal in place. The result is correctly rounded and
+ * does not depend on the locale
+ * @param str First character of the literal
+ * @param length Length of the literal, which must span it exactly
+ * @param dest Destination to save the result to
+ * @returns INVALID_NUMBER if str is not exactly one literal or
+ * NUMBER_OUT_OF_RANGE if it overflows, in which case dest is set to +-HUGE_VAL
+ */
+status_json_t ParseJsonDouble(const char *str, size_t length, double *dest);
+
+/**
+ * @brief Parses a number literal in place, truncating fractions
+ * @param str First character of the literal
+ * @param length Length of the literal, which must span it exactly
+ * @param dest Destination to save the result to
+ * @returns INVALID_NUMBER if str is not exactly one literal or
+ * NUMBER_OUT_OF_RANGE if it does not fit into a long
+ */
+status_json_t ParseJsonLong(const char *str, size_t length, long *dest);
+
+/**
+ * @brief Parses a number literal in place, truncating fractions
+ * @param str First character of the literal
+ * @param length Length of the literal, which must span it exactly
+ * @param dest Destination to save the result to
+ * @returns INVALID_NUMBER if str is not exactly one literal or
+ * NUMBER_OUT_OF_RANGE if it does not fit into an int
+ */
+status_json_t ParseJsonInt(const char *str, size_t length, int *dest);
+
 /**
  * @brief Converts a JSON Struct to a primitive value passed by pointer
  * @param json JSON object containing the value to be converted
  * @param type Type to be converted
  * @param dest Destination void pointer to save the result to
+ * @returns INVALID_NUMBER if a number is not a single valid literal or
+ * NUMBER_OUT_OF_RANGE if it does not fit into the requested type
  */
 status_json_t ConvertJsonToStandardType(string_json_t json,
                                         native_json_type_t type, void *dest);
@@ -135,4 +481,469 @@ status_json_t ConvertJsonToStandardType(string_json_t json,
 char *MapStringArray(void (*func)(char *, size_t, void *),
                      const char *const buffer, void *data, const size_t max);
 
+/**
+ * @brief Prepares a parser context for use. One context is needed per thread;
+ * every function in this library is reentrant and keeps no mutable state
+ * outside of its arguments. maxDepth starts at JSONMAXDEPTH and may be lowered
+ * afterwards to reject deeply nested input sooner
+ * @param parser Context to initialise
+ */
+void InitJsonParser(json_parser_t *parser);
+
+/**
+ * @brief Releases the scratch buffer of a parser context
+ * @param parser Context to release
+ */
+void FreeJsonParser(json_parser_t *parser);
+
+/**
+ * @brief Gets a property from a JSON object by the field name without copying
+ * the source document onto the stack
+ * @param parser Context of the calling thread; Documents nested deeper than
+ * its maxDepth fail with MEMORY_FAILURE
+ * @param src JSON object containing the key-value we want to get; It is only
+ * read, so it may be shared between threads
+ * @param dest Destination JSON string with the result of the operation; It may
+ * be the same object as src
+ * @param target Name of the field we want to get the value of
+ * @returns The status of the operation
+ */
+status_json_t ParserGetProperty(json_parser_t *parser, const string_json_t *src,
+                                string_json_t *dest, const char *target);
+
+/**
+ * @brief Iterates through all items in the JSON array using the scratch
+ * buffer of the parser instead of the stack
+ * @param parser Context of the calling thread
+ * @param func Callback function to trigger for every item
+ * @param buffer String containing the JSON array
+ * @param data Optional data pointer to pass to the callback
+ * @param max Max size of the array
+ */
+char *ParserMapStringArray(json_parser_t *parser,
+                           void (*func)(char *, size_t, void *),
+                           const char *const buffer, void *data,
+                           const size_t max);
+
+/**
+ * @brief Prepares a lookup cache for use. Like json_parser_t, a cache belongs
+ * to one thread
+ * @param cache Cache to initialise
+ */
+void InitJsonCache(json_cache_t *cache);
+
+/**
+ * @brief Gets a property from a JSON object by the field name, remembering
+ * where the key was found. A repeated lookup of the same key reads the value
+ * straight after it without scanning, once the key is confirmed to still be
+ * there; Otherwise the document is scanned again, so a buffer refilled in
+ * place is never served stale offsets. The cache binds to one document at a
+ * time and switches when src has a different address or length; A document
+ * with the same content keeps the cached offsets. The hits, misses and
+ * invalidations members of the cache count what happened. If a rewrite puts
+ * the key earlier as well, a hit may find a later occurrence than the scan
+ * @param cache Cache of the calling thread
+ * @param src JSON object containing the key-value we want to get; It is only
+ * read, so it may be shared between threads
+ * @param dest Destination JSON string with the result of the operation; When
+ * it is the same object as src the cache is invalidated
+ * @param target Name of the field we want to get the value of; Names of
+ * JSONCACHEKEYSIZE bytes or more, and names holding quotes or backslashes or
+ * starting with a structural character or whitespace, skip the cache
+ * @returns The status of the operation
+ */
+status_json_t CachedGetProperty(json_cache_t *cache, const string_json_t *src,
+                                string_json_t *dest, const char *target);
+
+/**
+ * @brief Drops every cached offset. Cached keys are confirmed before use, so
+ * this only saves the failed confirmations after a document is rewritten
+ * @param cache Cache to invalidate
+ */
+void InvalidateJsonCache(json_cache_t *cache);
+
+/**
+ * @brief Prepares a key-order predictor for use. A predictor learns the layout
+ * of one kind of record and belongs to one thread
+ * @param predictor Predictor to initialise
+ */
+void InitJsonPredictor(json_predictor_t *predictor);
+
+/**
+ * @brief Gets a property like GetJsonProperty3, first trying where the key was
+ * found in the previous record. Records that list their keys in the same order
+ * then cost one compare per key: the key is looked for at the offset it had
+ * last time and, when the values before it changed length, right after the
+ * value of the lookup before it. The key is verified in place and a miss falls
+ * back to a scan. A new record starts when src has another address or length,
+ * or when a key is looked up a second time. The hits and misses members of the
+ * predictor count what happened. If the key appears more than once, a hit may
+ * find a later occurrence than the scan would
+ * @param predictor Predictor of the calling thread, one per kind of record
+ * @param src JSON object containing the key-value we want to get
+ * @param dest Destination JSON string with the result of the operation
+ * @param target Name of the field we want to get the value of; Names of
+ * JSONCACHEKEYSIZE bytes or more, and names holding quotes or backslashes or
+ * starting with a structural character or whitespace, are always scanned for
+ * @returns The status of the operation
+ */
+status_json_t PredictedGetProperty(json_predictor_t *predictor,
+                                   const string_json_t *src,
+                                   string_json_t *dest, const char *target);
+
+/**
+ * @brief Copies the instrumentation counters of the calling thread. Cycles are
+ * TSC ticks on x86 and nanoseconds elsewhere
+ * @param dest Destination to save the counters to
+ * @returns UNSUPPORTED_OPERATION unless the library was built with JSON_STATS
+ */
+status_json_t GetJsonStats(stats_json_t *dest);
+
+/**
+ * @brief Zeroes the instrumentation counters of the calling thread
+ */
+void ResetJsonStats();
+
+/**
+ * @brief Registers a callback triggered after every profiled call made by the
+ * calling thread
+ * @param hook Callback receiving the name of the stats_json_t member that was
+ * updated and the cycles spent, or nullptr to remove it
+ * @param data Optional data pointer to pass to the callback
+ * @returns UNSUPPORTED_OPERATION unless the library was built with JSON_STATS
+ */
+status_json_t SetJsonProfileHook(profile_hook_json_t hook, void *data);
+
+/**
+ * @brief Creates an on-demand view of a JSON document. Nothing is parsed
+ * until a getter or a cursor reads a value, and then only the bytes that value
+ * needs. The document is not copied and not limited to JSONBUFFSIZE
+ * @param src Text of the JSON document; It must outlive every view of it
+ * @param length Length of the text
+ * @param dest Destination view of the root value
+ * @returns The status of the operation
+ */
+status_json_t ViewJson(const char *src, size_t length, json_view_t *dest);
+
+/**
+ * @brief Gets a direct member of an object view by the field name. Unlike
+ * GetProperty, nested objects are not searched
+ * @param object View of the object containing the key-value
+ * @param target Name of the field as written in the document
+ * @param dest Destination view of the value
+ * @returns UNDEFINED_KEY if the object has no such member
+ */
+status_json_t ViewGetField(json_view_t object, const char *target,
+                           json_view_t *dest);
+
+/**
+ * @brief Starts iterating over the items of an array or the members of an
+ * object
+ * @param container View of the array or object
+ * @param cursor Cursor to initialise
+ * @returns UNSUPPORTED_OPERATION if the view is not an array or object
+ */
+status_json_t ViewIterate(json_view_t container, json_cursor_t *cursor);
+
+/**
+ * @brief Moves an array cursor to the next item. The previous item is skipped
+ * without being decoded
+ * @param cursor Cursor created by ViewIterate on an array
+ * @param dest Destination view of the item
+ * @returns UNDEFINED_KEY once there are no items left
+ */
+status_json_t ViewNextItem(json_cursor_t *cursor, json_view_t *dest);
+
+/**
+ * @brief Moves an object cursor to the next member
+ * @param cursor Cursor created by ViewIterate on an object
+ * @param key Destination view of the name of the member
+ * @param value Destination view of the value of the member
+ * @returns UNDEFINED_KEY once there are no members left
+ */
+status_json_t ViewNextField(json_cursor_t *cursor, json_view_t *key,
+                            json_view_t *value);
+
+/**
+ * @brief Gets a string value without copying it. Escape sequences are left as
+ * written in the document
+ * @param view View of the string
+ * @param dest Destination pointer to the first character after the quotes
+ * @param length Destination for the length of the string in bytes
+ * @returns UNSUPPORTED_OPERATION if the view is not a terminated string
+ */
+status_json_t ViewGetString(json_view_t view, const char **dest,
+                            size_t *length);
+
+/**
+ * @brief Decodes a number value in place
+ * @param view View of the number
+ * @param dest Destination to save the result to
+ * @returns UNSUPPORTED_OPERATION if the view is not a number or
+ * NUMBER_OUT_OF_RANGE if it overflows a double
+ */
+status_json_t ViewGetDouble(json_view_t view, double *dest);
+
+/**
+ * @brief Decodes a number value in place, truncating fractions
+ * @param view View of the number
+ * @param dest Destination to save the result to
+ * @returns UNSUPPORTED_OPERATION if the view is not a number or
+ * NUMBER_OUT_OF_RANGE if it does not fit into a long
+ */
+status_json_t ViewGetLong(json_view_t view, long *dest);
+
+/**
+ * @brief Reads a boolean value
+ * @param view View of the boolean
+ * @param dest Destination to save the result to
+ * @returns UNSUPPORTED_OPERATION if the view is not a boolean
+ */
+status_json_t ViewGetBoolean(json_view_t view, bool *dest);
+
+/**
+ * @brief Decodes the members of every object in an array into one contiguous
+ * column per key, in a single pass over the array. Members that are missing or
+ * null are stored as zero and flagged in isPresent. If a key appears more than
+ * once in an object, the first one is used
+ * @param array View of an array of objects
+ * @param columns Columns to fill, each with room for capacity rows
+ * @param count Number of columns, at most JSONMAXCOLUMNS
+ * @param capacity Maximum number of rows
+ * @param rows Destination for the number of rows filled in
+ * @returns MEMORY_FAILURE if the array has more than capacity items,
+ * UNSUPPORTED_OPERATION if there are too many columns, an item is not an
+ * object or a member does not have the type of its column, or the status of
+ * the failing number conversion
+ */
+status_json_t ExtractJsonColumns(json_view_t array,
+                                 const column_json_t *columns, size_t count,
+                                 size_t capacity, size_t *rows);
+
+/**
+ * @brief Walks a whole document in a single pass and calls the handler for
+ * every token in document order, without copying anything. Memory use does
+ * not depend on the size of the document. Keys and scalars get a view of
+ * exactly their literal, start events a view that runs to the end of the
+ * document and end events a view of the closing bracket. depth is the number
+ * of containers around the token
+ * @param src Text of the JSON document
+ * @param length Length of the text
+ * @param handler Callbacks to run and the data to pass to them
+ * @returns FUNC_SUCCESS if the whole document was walked or a callback
+ * stopped it, or UNSUPPORTED_OPERATION if the document is malformed or nested
+ * deeper than JSONMAXDEPTH. Callbacks may already have run for the tokens
+ * before the error
+ */
+status_json_t ParseJsonEvents(const char *src, size_t length,
+                              const event_handler_json_t *handler);
+
+/**
+ * @brief Encodes a JSON document as a binary tape that can be queried without
+ * parsing: structure with skip offsets, pre-decoded numbers and unescaped
+ * strings with length prefixes. The document is not limited to JSONBUFFSIZE
+ * @param src Text of the JSON document
+ * @param length Length of the text
+ * @param dest Destination buffer, or nullptr to only compute the size
+ * @param capacity Size of the destination buffer
+ * @param written Size of the tape, also set when dest is too small
+ * @returns MEMORY_FAILURE if dest is too small or UNSUPPORTED_OPERATION if the
+ * document is not valid JSON
+ */
+status_json_t ConvertJsonToTape(const char *src, size_t length, void *dest,
+                                size_t capacity, size_t *written);
+
+/**
+ * @brief Writes a tape created by ConvertJsonToTape to disk
+ * @param tape Tape to write
+ * @param length Size of the tape
+ * @param path File to create or overwrite
+ * @returns The status of the operation
+ */
+status_json_t SaveJsonTape(const void *tape, size_t length, const char *path);
+
+/**
+ * @brief Validates a tape held in memory and gets its root value
+ * @param data Tape created by ConvertJsonToTape; It must outlive root
+ * @param length Size of the tape
+ * @param root Destination for the root value of the document
+ * @returns The status of the operation
+ */
+status_json_t OpenJsonTape(const void *data, size_t length, tape_json_t *root);
+
+/**
+ * @brief Maps a tape written by SaveJsonTape into memory. Nothing is parsed;
+ * pages are read from disk the first time a lookup touches them
+ * @param path File to map
+ * @param file Destination for the mapping, released with UnloadJsonTape
+ * @param root Destination for the root value of the document
+ * @returns The status of the operation
+ */
+status_json_t LoadJsonTape(const char *path, tape_file_json_t *file,
+                           tape_json_t *root);
+
+/**
+ * @brief Releases a mapping created by LoadJsonTape. Values read from it must
+ * no longer be used
+ * @param file Mapping to release
+ */
+void UnloadJsonTape(tape_file_json_t *file);
+
+/**
+ * @brief Gets a property from a tape object by the field name. Like
+ * GetJsonProperty3, the first matching key in document order wins
+ * @param src Object or array containing the key-value we want to get
+ * @param dest Destination for the value
+ * @param target Unescaped name of the field we want to get the value of
+ * @returns The status of the operation
+ */
+status_json_t GetTapeProperty(tape_json_t src, tape_json_t *dest,
+                              const char *target);
+
+/**
+ * @brief Gets a string value without copying it out of the tape
+ * @param src String value
+ * @param dest Destination pointer to the unescaped, null-terminated string
+ * @param length Destination for the length of the string in bytes
+ * @returns UNSUPPORTED_OPERATION if src is not a string
+ */
+status_json_t GetTapeString(tape_json_t src, const char **dest,
+                            size_t *length);
+
+/**
+ * @brief Converts a scalar tape value to a standard c-string. Strings are
+ * unescaped and numbers are printed with the shortest round-trip precision
+ * @param src Value to convert; Objects and arrays are not supported
+ * @param dest destination array of chars to store the result, of JSONBUFFSIZE
+ * bytes like in ConvertJsonToString
+ * @returns MEMORY_FAILURE if a string does not fit into JSONBUFFSIZE bytes
+ */
+status_json_t ConvertTapeToString(tape_json_t src, char *dest);
+
+/**
+ * @brief Converts a tape value to a primitive value passed by pointer. Numbers
+ * were decoded when the tape was created, so this does no parsing
+ * @param json Value to be converted
+ * @param type Type to be converted
+ * @param dest Destination void pointer to save the result to
+ * @returns UNSUPPORTED_OPERATION if the value does not have the requested type
+ * or NUMBER_OUT_OF_RANGE if it does not fit into it
+ */
+status_json_t ConvertTapeToStandardType(tape_json_t json,
+                                        native_json_type_t type, void *dest);
+
+/**
+ * @brief Reads files into a pool of buffers while worker threads process the
+ * ones already read. Regular files are read with io_uring where the kernel
+ * supports it. Otherwise, and on other systems, a pool of reader threads uses
+ * blocking reads; Pipes met while io_uring is in use are read on the calling
+ * thread. Returns once every callback has finished
+ * @param paths Files to read, including named pipes
+ * @param count Number of paths
+ * @param options Callback, buffer pool and number of workers
+ * @returns UNSUPPORTED_OPERATION if the options are out of range or
+ * MEMORY_FAILURE if the workers cannot be started. Failures to read a file are
+ * passed to its callback: UNSUPPORTED_OPERATION if it cannot be read and
+ * MEMORY_FAILURE if it does not fit into a buffer
+ */
+status_json_t IngestJsonFiles(const char *const *paths, size_t count,
+                              const ingest_options_json_t *options);
+
+/**
+ * @brief Initialises an empty interning table. A table is not thread-safe;
+ * Give every thread its own
+ * @param table Table to initialise
+ */
+void InitJsonIntern(json_intern_t *table);
+
+/**
+ * @brief Interns a sequence of bytes. Identical sequences resolve to the same
+ * null-terminated copy, which stays valid and in place until the table is
+ * initialised again, so interned strings can be compared by pointer
+ * @param table Table to store the string in
+ * @param str Bytes to intern
+ * @param length Number of bytes
+ * @param dest Destination pointer to the interned copy
+ * @returns MEMORY_FAILURE if the table has no room left for a new string
+ */
+status_json_t InternJsonString(json_intern_t *table, const char *str,
+                               size_t length, const char **dest);
+
+/**
+ * @brief Converts a json string to an interned standard c-string
+ * @param table Table to store the string in
+ * @param src string in json format
+ * @param dest Destination pointer to the interned copy
+ * @returns MEMORY_FAILURE if the table has no room left for a new string
+ */
+status_json_t ConvertJsonToInternedString(json_intern_t *table,
+                                          const string_json_t *src,
+                                          const char **dest);
+
+/**
+ * @brief Gets a string value or an object key from a view and interns it.
+ * Escape sequences are left as written in the document
+ * @param table Table to store the string in
+ * @param view View of the string
+ * @param dest Destination pointer to the interned copy
+ * @returns UNSUPPORTED_OPERATION if the view is not a terminated string or
+ * MEMORY_FAILURE if the table has no room left for a new string
+ */
+status_json_t ViewGetInternedString(json_intern_t *table, json_view_t view,
+                                    const char **dest);
+
+/**
+ * @brief Writes the JSON Merge Patch (RFC 7386) that turns one document into
+ * another. Members are compared as written, so unchanged ones are skipped
+ * without being decoded, and changed values are copied as written
+ * @param original View of the document before the change
+ * @param modified View of the document after the change
+ * @param dest Destination buffer for the null-terminated patch, or nullptr to
+ * only compute the size
+ * @param capacity Size of the destination buffer
+ * @param written Length of the patch, also set when dest is too small
+ * @returns MEMORY_FAILURE if dest is too small or UNSUPPORTED_OPERATION if a
+ * document is malformed or modified sets a member to null, which a merge patch
+ * cannot express
+ */
+status_json_t DiffJson(json_view_t original, json_view_t modified, char *dest,
+                       size_t capacity, size_t *written);
+
+/**
+ * @brief Applies a JSON Merge Patch (RFC 7386) to a document. Members the
+ * patch does not touch are copied as written
+ * @param target View of the document to patch
+ * @param patch View of the merge patch
+ * @param dest Destination buffer for the null-terminated result, or nullptr to
+ * only compute the size
+ * @param capacity Size of the destination buffer
+ * @param written Length of the result, also set when dest is too small
+ * @returns MEMORY_FAILURE if dest is too small or UNSUPPORTED_OPERATION if a
+ * document is malformed
+ */
+status_json_t ApplyJsonMergePatch(json_view_t target, json_view_t patch,
+                                  char *dest, size_t capacity,
+                                  size_t *written);
+
+/**
+ * @brief Writes a copy of an object that keeps only the members on the given
+ * paths, in document order. Kept values are copied as written and everything
+ * else is skipped without being decoded. Objects on the way to a kept member
+ * are written with just the members they lead to, and left out when none of
+ * them exists
+ * @param src View of the object
+ * @param paths Keys of the members to keep, as written in the document. Keys
+ * separated by a period name a member of a nested object, like "a.b"
+ * @param count Number of paths, at most JSONMAXPATHS
+ * @param dest Destination buffer for the null-terminated copy, or nullptr to
+ * only compute the size
+ * @param capacity Size of the destination buffer
+ * @param written Length of the copy, also set when dest is too small
+ * @returns MEMORY_FAILURE if dest is too small or UNSUPPORTED_OPERATION if src
+ * is not an object, is malformed or there are too many paths
+ */
+status_json_t ProjectJson(json_view_t src, const char *const *paths,
+                          size_t count, char *dest, size_t capacity,
+                          size_t *written);
+
 #endif
@@ -1,40 +1,65 @@
-#include "json.h"
-#include <ctype.h>
+#if defined(JSON_STATS) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+#include "json_internal.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/types.h>
-
-// Private members
-
-static status_json_t TrimEnds(string_json_t *src)
+#ifdef JSON_STATS
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#endif
+
+// Instrumentation, only compiled in with -DJSON_STATS. Counters live in
+// thread-local storage so that the library stays free of shared state
+
+#ifdef JSON_STATS
+static thread_local stats_json_t stats;
+static thread_local profile_hook_json_t profileHook;
+static thread_local void *profileHookData;
+
+static inline unsigned long long ReadCycles()
 {
-  if (src->length <= 2)
-    return MEMORY_FAILURE;
-  memcpy(src->str, &src->str[1], src->length - 2);
-  src->length = src->length - 2;
-  return FUNC_SUCCESS;
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec * 1000000000ull + now.tv_nsec;
+#endif
 }
 
-static status_json_t GetWordBetweenIndexes(const string_json_t src,
-                                           const size_t start, const size_t end,
-                                           string_json_t *dest, bool trimEnds)
+static void EndProfile(call_stats_json_t *call, const char *function,
+                       const unsigned long long start)
 {
-  const ssize_t length = end - start + 1;
-  if (length < 1)
-    return MEMORY_FAILURE;
+  const unsigned long long cycles = ReadCycles() - start;
+  call->calls++;
+  call->cycles += cycles;
+  if (profileHook != nullptr)
+    profileHook(function, cycles, profileHookData);
+}
 
-  memcpy(dest->str, &src.str[start], length);
-  dest->length = length;
+#define STATS_ADD(field, amount) (stats.field += (amount))
+#define PROFILE_BEGIN() const unsigned long long profileStart = ReadCycles()
+#define PROFILE_END(field) EndProfile(&stats.field, #field, profileStart)
+#else
+#define STATS_ADD(field, amount) ((void)0)
+#define PROFILE_BEGIN() ((void)0)
+#define PROFILE_END(field) ((void)0)
+#endif
 
-  status_json_t status;
-  if (trimEnds && (status = TrimEnds(dest)) != FUNC_SUCCESS)
-  {
-    return status;
-  }
+// Private members
 
-  return FUNC_SUCCESS;
-}
+// Location of a value inside the document it was found in
+typedef struct
+{
+  offset_json_t offset;
+  offset_json_t length;
+  type_json_t type;
+} value_span_t;
 
 static type_json_t GetJSONType(const char c)
 {
@@ -69,25 +94,31 @@ static bool TypeRequiresDelimiter(type_json_t type)
   }
 }
 
-static status_json_t GetValue(string_json_t src, const ssize_t iStartAt,
-                              string_json_t *dest)
+// Finds the value of the key whose closing quotes are at src->str[iStartAt].
+// Scanning stops before iEnd, which is exclusive, so the caller can leave the
+// enclosing braces in place. Strings are returned without their double quotes
+static status_json_t FindValue(const string_json_t *src, const size_t iStartAt,
+                               const size_t iEnd, value_span_t *span)
 {
-  if (iStartAt < 0 || src.length == 0)
+  if (iEnd > src->length || iStartAt >= iEnd)
     return MEMORY_FAILURE;
 
+  PROFILE_BEGIN();
   ssize_t iStartWord = -1, iEndWord = -1;
   size_t fieldNestingLevel = 0;
   bool isCurrentWordValue = false;
   bool isCurrentIndexInsideDoubleQuotes = false;
+  bool isEscaped = false;
   type_json_t type = JUNDEFINED;
-  for (size_t i = iStartAt + 1; i < src.length; i++)
+  size_t i;
+  for (i = iStartAt + 1; i < iEnd; i++)
   {
-    // Ignoring spaces unless the type requires delimiters
-    if (src.str[i] == SPACE && TypeRequiresDelimiter(type))
+    // Ignoring whitespace unless the type requires delimiters
+    if (IsWhitespace(src->str[i]) && TypeRequiresDelimiter(type))
       continue;
 
     // This is needed so that we know that we can start reading the value
-    if (src.str[i] == COLON)
+    if (src->str[i] == COLON)
     {
       isCurrentWordValue = true;
       continue;
@@ -102,8 +133,7 @@ static status_json_t GetValue(string_json_t src, const ssize_t iStartAt,
     // Make sure to assign a type to the current json being read
     if (type == JUNDEFINED)
     {
-      type = GetJSONType(src.str[i]);
-      dest->type = type;
+      type = GetJSONType(src->str[i]);
       iStartWord = i;
 
       if (type == JOBJECT || type == JARRAY)
@@ -119,8 +149,7 @@ static status_json_t GetValue(string_json_t src, const ssize_t iStartAt,
 
     // Strings are the most basic type to parse because we just need to return
     // the indexes of the start and end of the double quotes
-    if (src.str[i] == DOUBLE_QUOTES && src.str[i - 1] != BACKSLASH &&
-        type == JSTRING)
+    if (type == JSTRING && !ReadStringCharacter(src->str[i], &isEscaped))
     {
       iEndWord = i;
       break;
@@ -130,13 +159,14 @@ static status_json_t GetValue(string_json_t src, const ssize_t iStartAt,
     // end of the stream and return whatever has been read
     if (type == JBOOLEAN || type == JNULL)
     {
-      if (src.str[i] == SPACE || src.str[i] == COMMA)
+      if (IsWhitespace(src->str[i]) || src->str[i] == COMMA ||
+          src->str[i] == CURLY_CLOSE || src->str[i] == SQUARE_CLOSE)
       {
         iEndWord = i - 1;
         break;
       }
 
-      if (i >= src.length - 1)
+      if (i >= iEnd - 1)
       {
         iEndWord = i;
         break;
@@ -145,21 +175,16 @@ static status_json_t GetValue(string_json_t src, const ssize_t iStartAt,
 
     // Numbers are a little trickier, we need to make sure to return the number
     // as soon as there aren't any digits left in the current readable stream.
-    // This excludes some annoyances like the period to declare decimal values
+    // This excludes some annoyances like signs, periods and exponents
     if (type == JNUMBER)
     {
-      if (src.str[i] == PERIOD)
-      {
-        continue;
-      }
-
-      if (!isdigit(src.str[i]) || src.str[i] == SPACE)
+      if (!IsNumberCharacter(src->str[i]))
       {
         iEndWord = i - 1;
         break;
       }
 
-      if (i >= src.length - 1)
+      if (i >= iEnd - 1)
       {
         iEndWord = i;
         break;
@@ -172,21 +197,25 @@ static status_json_t GetValue(string_json_t src, const ssize_t iStartAt,
     // for nested arrays
     if (type == JARRAY)
     {
-      if (src.str[i] == DOUBLE_QUOTES && i - 1 > 0 &&
-          src.str[i - 1] != BACKSLASH)
+      if (isCurrentIndexInsideDoubleQuotes)
       {
-        isCurrentIndexInsideDoubleQuotes = !isCurrentIndexInsideDoubleQuotes;
+        isCurrentIndexInsideDoubleQuotes =
+            ReadStringCharacter(src->str[i], &isEscaped);
+        continue;
       }
 
-      if (isCurrentIndexInsideDoubleQuotes)
+      if (src->str[i] == DOUBLE_QUOTES)
+      {
+        isCurrentIndexInsideDoubleQuotes = true;
         continue;
+      }
 
-      if (src.str[i] == SQUARE_OPEN)
+      if (src->str[i] == SQUARE_OPEN)
       {
         fieldNestingLevel++;
       }
 
-      if (src.str[i] == SQUARE_CLOSE)
+      if (src->str[i] == SQUARE_CLOSE)
       {
         fieldNestingLevel--;
         if (fieldNestingLevel == 0)
@@ -201,19 +230,23 @@ static status_json_t GetValue(string_json_t src, const ssize_t iStartAt,
     // readable I separated them, but they just do the same thing essentially
     if (type == JOBJECT)
     {
-      if (src.str[i] == DOUBLE_QUOTES && i - 1 > 0 &&
-          src.str[i - 1] != BACKSLASH)
+      if (isCurrentIndexInsideDoubleQuotes)
       {
-        isCurrentIndexInsideDoubleQuotes = !isCurrentIndexInsideDoubleQuotes;
+        isCurrentIndexInsideDoubleQuotes =
+            ReadStringCharacter(src->str[i], &isEscaped);
+        continue;
       }
 
-      if (isCurrentIndexInsideDoubleQuotes)
+      if (src->str[i] == DOUBLE_QUOTES)
+      {
+        isCurrentIndexInsideDoubleQuotes = true;
         continue;
+      }
 
-      if (src.str[i] == CURLY_OPEN)
+      if (src->str[i] == CURLY_OPEN)
         fieldNestingLevel++;
 
-      if (src.str[i] == CURLY_CLOSE)
+      if (src->str[i] == CURLY_CLOSE)
       {
         fieldNestingLevel--;
         if (fieldNestingLevel == 0)
@@ -225,13 +258,35 @@ static status_json_t GetValue(string_json_t src, const ssize_t iStartAt,
     }
   }
 
-  status_json_t status;
-  if ((status = GetWordBetweenIndexes(src, iStartWord, iEndWord, dest,
-                                      type == JSTRING)) != FUNC_SUCCESS)
+  STATS_ADD(bytesScanned, i - iStartAt);
+  PROFILE_END(getValue);
+
+  // Unterminated values leave either index unset
+  if (iStartWord < 0 || iEndWord < iStartWord ||
+      (type == JSTRING && iEndWord == iStartWord))
   {
-    return status;
+    return MEMORY_FAILURE;
   }
 
+  span->offset = type == JSTRING ? iStartWord + 1 : iStartWord;
+  span->length = iEndWord - span->offset + (type == JSTRING ? 0 : 1);
+  span->type = type;
+  return FUNC_SUCCESS;
+}
+
+// dest may alias src, which is what lets queries run in place. A buffer that
+// holds src is large enough for the span, so aliasing never reallocates
+static status_json_t CopySpan(const string_json_t *src,
+                              const value_span_t *span, string_json_t *dest)
+{
+  status_json_t status;
+  if ((status = ReserveJsonString(dest, span->length)) != FUNC_SUCCESS)
+    return status;
+
+  memmove(dest->str, &src->str[span->offset], span->length);
+  dest->length = span->length;
+  dest->type = span->type;
+  STATS_ADD(bytesCopied, span->length);
   return FUNC_SUCCESS;
 }
 
@@ -249,237 +304,592 @@ static native_json_type_t GetUnderlyingType(native_json_type_t type)
   }
 }
 
-// Public members
-
-status_json_t ConvertJsonToString(string_json_t src, char *const dest)
+// Finds target among the keys of the object whose opening brace is at
+// src->str[iBegin], at any depth below maxDepth, and stores the index of the
+// closing quotes of the key in iKey. Keys are compared in place, so nothing is
+// written to
+static status_json_t ScanKey(const string_json_t *src, const size_t iBegin,
+                             const size_t iEnd, const char *target,
+                             const size_t targetLength, const size_t maxDepth,
+                             size_t *iKey)
 {
-  // Passing an empty string if propety is empty
-  if (src.length == 2 && src.type == JSTRING)
+  // A string is only a key when the innermost container is an object, so one
+  // bit per nesting level remembers which kind of container was opened
+  unsigned char objectLevels[MAX_NESTING_LEVEL / CHAR_BIT] = {1};
+  size_t nestingLevel = 0;
+  bool isCurrentWordKey = true;
+  bool isInsideString = false, isEscaped = false;
+  ssize_t iStartWord = -1;
+  size_t i;
+  for (i = iBegin + 1; i < iEnd; i++)
   {
-    memcpy(dest, "", 1);
-    return FUNC_SUCCESS;
+    const char c = src->str[i];
+    if (isInsideString)
+    {
+      if ((isInsideString = ReadStringCharacter(c, &isEscaped)) ||
+          iStartWord < 0)
+      {
+        continue;
+      }
+
+      STATS_ADD(keysCompared, 1);
+      const size_t keyLength = i - iStartWord - 1;
+      if (keyLength == targetLength &&
+          memcmp(&src->str[iStartWord + 1], target, keyLength) == 0)
+      {
+        break;
+      }
+
+      iStartWord = -1;
+      continue;
+    }
+
+    switch (c)
+    {
+    case DOUBLE_QUOTES:
+      isInsideString = true;
+      if (isCurrentWordKey)
+      {
+        iStartWord = i;
+      }
+      break;
+    case CURLY_OPEN:
+    case SQUARE_OPEN:
+      if (++nestingLevel >= maxDepth)
+      {
+        return MEMORY_FAILURE;
+      }
+      if (c == CURLY_OPEN)
+      {
+        objectLevels[nestingLevel / CHAR_BIT] |= 1u << nestingLevel % CHAR_BIT;
+      }
+      else
+      {
+        objectLevels[nestingLevel / CHAR_BIT] &=
+            ~(1u << nestingLevel % CHAR_BIT);
+      }
+      isCurrentWordKey = c == CURLY_OPEN;
+      break;
+    case CURLY_CLOSE:
+    case SQUARE_CLOSE:
+      // The object being searched ends here
+      if (nestingLevel == 0)
+      {
+        STATS_ADD(bytesScanned, i - iBegin);
+        return UNDEFINED_KEY;
+      }
+      nestingLevel--;
+      isCurrentWordKey = false;
+      break;
+    case COLON:
+      isCurrentWordKey = false;
+      break;
+    case COMMA:
+      isCurrentWordKey = objectLevels[nestingLevel / CHAR_BIT] >>
+                             nestingLevel % CHAR_BIT &
+                         1;
+      break;
+    }
   }
 
-  if (src.length >= JSONBUFFSIZE)
-    return MEMORY_FAILURE;
+  STATS_ADD(bytesScanned, i - iBegin);
+  if (i >= iEnd)
+  {
+    return UNDEFINED_KEY;
+  }
 
-  memcpy(dest, src.str, src.length);
-  dest[src.length] = '\0';
+  *iKey = i;
   return FUNC_SUCCESS;
 }
 
-status_json_t ConvertStringToJson(const char *src, string_json_t *dest)
+// Stores the indexes of the outer braces in iBegin and iEnd
+static status_json_t FindObjectBounds(const string_json_t *src, size_t *iBegin,
+                                      size_t *iEnd)
 {
-  const size_t size = strlen(src);
-  if (size >= JSONBUFFSIZE)
-    return MEMORY_FAILURE;
-  for (size_t i = 0; i < size; i++)
+  // Pretty-printed documents may carry whitespace around the outer braces
+  *iBegin = SkipWhitespace(src->str, 0, src->length);
+  *iEnd = src->length;
+  while (*iEnd > *iBegin && IsWhitespace(src->str[*iEnd - 1]))
+    (*iEnd)--;
+
+  // The outer braces themselves are excluded from the scan
+  if (*iEnd - *iBegin <= 2)
   {
-    dest->str[i] = src[i];
+    return MEMORY_FAILURE;
   }
-  dest->length = size;
+  (*iEnd)--;
   return FUNC_SUCCESS;
 }
 
-status_json_t GetJsonProperty3(string_json_t src, string_json_t *dest,
-                               const char *target)
+static status_json_t ScanProperty(const string_json_t *src,
+                                  const char *target, const size_t maxDepth,
+                                  value_span_t *span)
 {
-  if (src.length <= 0 || strlen(target) >= JSONBUFFSIZE)
+  const size_t targetLength = strlen(target);
+  if (src->length <= 0 || targetLength >= JSONBUFFSIZE)
   {
     return MEMORY_FAILURE;
   }
 
+  size_t iBegin, iEnd, iKey;
   status_json_t status;
-  if ((status = TrimEnds(&src)) != FUNC_SUCCESS)
+  if ((status = FindObjectBounds(src, &iBegin, &iEnd)) != FUNC_SUCCESS ||
+      (status = ScanKey(src, iBegin, iEnd, target, targetLength, maxDepth,
+                        &iKey)) != FUNC_SUCCESS)
   {
     return status;
   }
 
-  bool isCurrentWordKey = true;
-  ssize_t iStartWord = -1, iEndWord = -1;
-  size_t doubleQuoteCount = 0;
-  for (size_t i = 0; i < src.length; i++)
+  return FindValue(src, iKey, iEnd, span);
+}
+
+// Finds target among the members of the object whose opening brace is at
+// src->str[iBegin], skipping over their values, and stores the index of the
+// closing quotes of the key in iKey
+static status_json_t ScanMember(const string_json_t *src, const size_t iBegin,
+                                const char *target, const size_t targetLength,
+                                size_t *iKey)
+{
+  size_t i = SkipWhitespace(src->str, iBegin + 1, src->length);
+  while (i < src->length && src->str[i] == DOUBLE_QUOTES)
   {
-    if (src.str[i] == DOUBLE_QUOTES)
+    const size_t iAfterKey = SkipString(src->str, i, src->length);
+    if (iAfterKey == i)
     {
-      doubleQuoteCount++;
+      return MEMORY_FAILURE;
     }
 
-    if (src.str[i] == COLON && isCurrentWordKey && doubleQuoteCount % 2 == 0)
+    STATS_ADD(keysCompared, 1);
+    if (iAfterKey - i - 2 == targetLength &&
+        memcmp(&src->str[i + 1], target, targetLength) == 0)
     {
-      isCurrentWordKey = false;
-      continue;
+      *iKey = iAfterKey - 1;
+      return FUNC_SUCCESS;
     }
 
-    if (src.str[i] == COMMA && !isCurrentWordKey && doubleQuoteCount % 2 == 0)
+    i = SkipWhitespace(src->str, iAfterKey, src->length);
+    if (i >= src->length || src->str[i] != COLON)
     {
-      isCurrentWordKey = true;
-      continue;
+      return MEMORY_FAILURE;
+    }
+    i = SkipWhitespace(src->str, i + 1, src->length);
+    const size_t iAfterValue =
+        i < src->length ? SkipValue(src->str, i, src->length) : i;
+    if (iAfterValue == i)
+    {
+      return MEMORY_FAILURE;
     }
 
-    if (src.str[i] == DOUBLE_QUOTES && isCurrentWordKey)
+    i = SkipWhitespace(src->str, iAfterValue, src->length);
+    if (i >= src->length || src->str[i] != COMMA)
     {
-      if (iStartWord < 0)
-      {
-        iStartWord = i;
-        continue;
-      }
-      else if (iEndWord < 0)
-      {
-        iEndWord = i;
+      break;
+    }
+    i = SkipWhitespace(src->str, i + 1, src->length);
+  }
 
-        string_json_t value;
-        status_json_t status;
-        if ((status = GetWordBetweenIndexes(src, iStartWord, iEndWord, &value,
-                                            true)) != FUNC_SUCCESS)
-        {
-          return MEMORY_FAILURE;
-        }
+  STATS_ADD(bytesScanned, i - iBegin);
+  return UNDEFINED_KEY;
+}
 
-        char cStr[JSONBUFFSIZE];
-        if ((status = ConvertJsonToString(value, cStr)) != FUNC_SUCCESS)
-        {
-          return MEMORY_FAILURE;
-        }
+// Follows a path of keys separated by periods and stores the index of the
+// first byte of the last value in iValue. The first key is found at any depth,
+// as GetJsonProperty3 finds it, and each one after it among the members of the
+// value before it. Nothing after the first byte of the last value is read
+static status_json_t ScanPath(const string_json_t *src, const char *path,
+                              size_t *iValue)
+{
+  size_t i = SkipWhitespace(src->str, 0, src->length);
+  if (i >= src->length || src->str[i] != CURLY_OPEN)
+  {
+    return UNSUPPORTED_OPERATION;
+  }
 
-        if (strcmp(cStr, target) == 0)
-        {
-          GetValue(src, i, dest);
-          return FUNC_SUCCESS;
-        }
+  bool isFirstKey = true;
+  for (;;)
+  {
+    const char *separator = strchr(path, PERIOD);
+    const size_t keyLength =
+        separator != nullptr ? (size_t)(separator - path) : strlen(path);
+
+    size_t iKey;
+    const status_json_t status =
+        isFirstKey ? ScanKey(src, i, src->length, path, keyLength,
+                             MAX_NESTING_LEVEL, &iKey)
+                   : ScanMember(src, i, path, keyLength, &iKey);
+    if (status != FUNC_SUCCESS)
+    {
+      return status;
+    }
 
-        iStartWord = -1;
-        iEndWord = -1;
-      }
+    i = SkipWhitespace(src->str, iKey + 1, src->length);
+    if (i >= src->length || src->str[i] != COLON)
+    {
+      return MEMORY_FAILURE;
+    }
+    i = SkipWhitespace(src->str, i + 1, src->length);
+    if (i >= src->length)
+    {
+      return MEMORY_FAILURE;
+    }
+
+    if (separator == nullptr)
+    {
+      *iValue = i;
+      return FUNC_SUCCESS;
+    }
+
+    // Only objects have keys to look further into
+    if (src->str[i] != CURLY_OPEN)
+    {
+      return UNDEFINED_KEY;
     }
+    path = separator + 1;
+    isFirstKey = false;
   }
-  return UNDEFINED_KEY;
 }
 
-status_json_t GetJsonProperty2(string_json_t *srcDest, const char *target)
+static status_json_t FindProperty(const string_json_t *src, string_json_t *dest,
+                                  const char *target, const size_t maxDepth)
 {
-  return GetJsonProperty3(*srcDest, srcDest, target);
+  PROFILE_BEGIN();
+  value_span_t span;
+  status_json_t status = ScanProperty(src, target, maxDepth, &span);
+  if (status == FUNC_SUCCESS)
+  {
+    status = CopySpan(src, &span, dest);
+  }
+  PROFILE_END(getProperty);
+  return status;
 }
 
-status_json_t ConvertJsonToStandardType(string_json_t json,
-                                        native_json_type_t type, void *dest)
+// Slots tried before the cache evicts the first one
+constexpr size_t CACHE_PROBES = 4;
+
+// Cached offsets only make sense for the document they were found in, so
+// switching to a document with a different content drops them
+static void BindCache(json_cache_t *cache, const string_json_t *src)
 {
-  char temp[BUFSIZ];
-  status_json_t status;
+  if (cache->document == src && cache->documentLength == src->length)
+  {
+    return;
+  }
 
-  switch (type)
+  const unsigned long long hash = HashBytes(src->str, src->length);
+  if (cache->document != nullptr &&
+      (cache->documentLength != src->length || cache->documentHash != hash))
   {
-  case JSON_DOUBLE:
-    if ((status = ConvertJsonToString(json, temp)) != FUNC_SUCCESS)
-    {
-      return status;
-    }
+    InvalidateJsonCache(cache);
+  }
 
-    *(double *)dest = strtod(temp, nullptr);
-    break;
+  cache->document = src;
+  cache->documentLength = src->length;
+  cache->documentHash = hash;
+}
 
-  case JSON_LONG:
-    if ((status = ConvertJsonToString(json, temp)) != FUNC_SUCCESS)
+// Returns the entry holding target, or the slot it should be stored in
+static cache_entry_json_t *FindCacheEntry(json_cache_t *cache,
+                                          const char *target,
+                                          const unsigned long long keyHash,
+                                          bool *isHit)
+{
+  cache_entry_json_t *freeEntry = nullptr;
+  for (size_t probe = 0; probe < CACHE_PROBES; probe++)
+  {
+    cache_entry_json_t *entry =
+        &cache->entries[(keyHash + probe) % JSONCACHESIZE];
+    if (!entry->isUsed)
     {
-      return status;
+      if (freeEntry == nullptr)
+      {
+        freeEntry = entry;
+      }
+      continue;
     }
 
-    *(long *)dest = strtol(temp, nullptr, 10);
-    break;
-
-  case JSON_INT:
-    if ((status = ConvertJsonToString(json, temp)) != FUNC_SUCCESS)
+    if (entry->keyHash == keyHash && strcmp(entry->key, target) == 0)
     {
-      return status;
+      *isHit = true;
+      return entry;
     }
+  }
 
-    *(int *)dest = atoi(temp);
-    break;
+  *isHit = false;
+  return freeEntry != nullptr ? freeEntry
+                              : &cache->entries[keyHash % JSONCACHESIZE];
+}
 
-  case JSON_BOOLEAN:
-    if ((status = ConvertJsonToString(json, temp)) != FUNC_SUCCESS)
-    {
-      return status;
-    }
+// A key can only be verified in place when its quotes cannot be taken for
+// any other quotes of a valid document. Without quotes or backslashes in it,
+// and starting with a byte that cannot follow a string, it cannot end one
+static bool IsPredictableKey(const char *target, const size_t targetLength)
+{
+  if (targetLength == 0 || IsWhitespace(target[0]) || target[0] == COMMA ||
+      target[0] == COLON || target[0] == CURLY_CLOSE ||
+      target[0] == SQUARE_CLOSE)
+  {
+    return false;
+  }
 
-    *(bool *)dest = strcmp(temp, "true") == 0 ? true : false;
-    break;
+  for (size_t i = 0; i < targetLength; i++)
+  {
+    if (target[i] == DOUBLE_QUOTES || target[i] == BACKSLASH)
+      return false;
+  }
+  return true;
+}
 
-  case JSON_DOUBLE_ARR:
-  case JSON_LONG_ARR:
-  case JSON_INT_ARR:
-    array_json_t *arr = (array_json_t *)dest;
-    if (json.length < 3)
+// Tells whether the key written at src->str[i], between iBegin and iEnd, is
+// target. A quote right after an opening brace or a comma opens a string, and
+// a string followed by a colon is a key
+static bool IsKeyAt(const string_json_t *src, const size_t i,
+                    const size_t iBegin, const size_t iEnd,
+                    const char *target, const size_t targetLength)
+{
+  if (i <= iBegin || i >= iEnd || targetLength + 2 > iEnd - i ||
+      src->str[i] != DOUBLE_QUOTES ||
+      memcmp(&src->str[i + 1], target, targetLength) != 0 ||
+      src->str[i + targetLength + 1] != DOUBLE_QUOTES)
+  {
+    return false;
+  }
+
+  size_t iBefore = i - 1;
+  while (iBefore > iBegin && IsWhitespace(src->str[iBefore]))
+    iBefore--;
+  const size_t iAfter = SkipWhitespace(src->str, i + targetLength + 2, iEnd);
+  return (src->str[iBefore] == CURLY_OPEN || src->str[iBefore] == COMMA) &&
+         iAfter < iEnd && src->str[iAfter] == COLON;
+}
+
+// Index of the first key that may follow a value ending at i, past the
+// separators and the closing brackets of the containers it ends
+static size_t SkipToNextKey(const string_json_t *src, size_t i,
+                            const size_t iEnd)
+{
+  for (; i < iEnd; i++)
+  {
+    const char c = src->str[i];
+    if (!IsWhitespace(c) && c != COMMA && c != CURLY_CLOSE &&
+        c != SQUARE_CLOSE)
     {
-      arr->length = 0; // Empty array
       break;
     }
+  }
+  return i;
+}
 
-    bool isReading = false;
-    ssize_t iStartNum = -1, iEndNum = -1;
-    size_t iArr = 0;
-    for (size_t i = 0; i < json.length; i++)
+// Starts a new record when the document changed or the key was already looked
+// up in the current one, and returns the entry of target
+static prediction_entry_json_t *
+BindRecord(json_predictor_t *predictor, const string_json_t *src,
+           const char *target, const unsigned long long keyHash, bool *isHit)
+{
+  prediction_entry_json_t *freeEntry = nullptr, *entry = nullptr;
+  for (size_t probe = 0; probe < CACHE_PROBES && entry == nullptr; probe++)
+  {
+    prediction_entry_json_t *candidate =
+        &predictor->entries[(keyHash + probe) % JSONCACHESIZE];
+    if (!candidate->isUsed)
     {
-      if (isdigit(json.str[i]) && !isReading)
-      {
-        isReading = true;
-        iStartNum = i;
-      }
+      if (freeEntry == nullptr)
+        freeEntry = candidate;
+    }
+    else if (candidate->keyHash == keyHash &&
+             strcmp(candidate->key, target) == 0)
+    {
+      entry = candidate;
+    }
+  }
 
-      if (json.str[i] == PERIOD || !isReading)
+  *isHit = entry != nullptr;
+  if (predictor->document != src || predictor->documentLength != src->length ||
+      (entry != nullptr && entry->record == predictor->records))
+  {
+    predictor->document = src;
+    predictor->documentLength = src->length;
+    predictor->records++;
+    predictor->ordinal = 0;
+  }
+
+  if (entry != nullptr)
+    return entry;
+  return freeEntry != nullptr ? freeEntry
+                              : &predictor->entries[keyHash % JSONCACHESIZE];
+}
+
+// Items are copied into tempBuff, which must hold JSONBUFFSIZE bytes
+static char *MapArray(void (*func)(char *, size_t, void *),
+                      const char *const buffer, void *data, const size_t max,
+                      char *const tempBuff)
+{
+  if (max <= 3)
+  {
+    return nullptr;
+  }
+
+  PROFILE_BEGIN();
+  size_t i = SkipWhitespace(buffer, 1, max - 1), items = 0;
+  const type_json_t type = GetJSONType(buffer[i]);
+  const bool isContainer = type == JOBJECT || type == JARRAY;
+  const char open = type == JOBJECT ? CURLY_OPEN : SQUARE_OPEN;
+  const char close = type == JOBJECT ? CURLY_CLOSE : SQUARE_CLOSE;
+  ssize_t startIndex = -1, endIndex = -1;
+  size_t nestingLevel = 0;
+  bool betweenQuotes = false, isEscaped = false;
+  for (char c; i <= max - 2 && (c = buffer[i]) != '\0'; i++)
+  {
+    // Anything inside a string is skipped, escaped double quotes included
+    if (betweenQuotes)
+    {
+      betweenQuotes = ReadStringCharacter(c, &isEscaped);
+      if (betweenQuotes || isContainer)
       {
         continue;
       }
 
-      if (i >= json.length - 1)
+      // Strings are handed over without their double quotes
+      startIndex++;
+      endIndex = i;
+    }
+    else if (c == DOUBLE_QUOTES)
+    {
+      betweenQuotes = true;
+      if (!isContainer)
       {
-        iEndNum = i - 1;
-        goto endLoop;
+        startIndex = i;
       }
-
-      if (!isdigit(json.str[i]))
+      continue;
+    }
+    else if (isContainer && c == open)
+    {
+      if (nestingLevel++ == 0)
       {
-        iEndNum = i;
-        goto endLoop;
+        startIndex = i;
       }
+      continue;
+    }
+    else if (isContainer && c == close && nestingLevel > 0)
+    {
+      if (--nestingLevel > 0)
+      {
+        continue;
+      }
+      endIndex = i + 1;
+    }
+    else
+    {
+      continue;
+    }
+
+    memcpy(tempBuff, &buffer[startIndex], endIndex - startIndex);
+    tempBuff[endIndex - startIndex] = '\0';
+    STATS_ADD(bytesCopied, endIndex - startIndex);
+    func(tempBuff, items++, data);
+    startIndex = -1;
+    endIndex = -1;
+  }
+
+  STATS_ADD(bytesScanned, i);
+  PROFILE_END(mapStringArray);
+  return nullptr;
+}
+
+// Converts every item of an array of numbers. The literals are parsed in
+// place, with their sign, fraction and exponent
+static status_json_t ConvertNumberArray(const string_json_t *json,
+                                        const native_json_type_t type,
+                                        array_json_t *arr)
+{
+  size_t i = SkipWhitespace(json->str, 0, json->length);
+  if (i >= json->length || json->str[i] != SQUARE_OPEN)
+  {
+    return UNSUPPORTED_OPERATION;
+  }
+
+  arr->length = 0;
+  i = SkipWhitespace(json->str, i + 1, json->length);
+  if (i < json->length && json->str[i] == SQUARE_CLOSE)
+  {
+    return FUNC_SUCCESS; // Empty array
+  }
+
+  for (size_t iArr = 0;; iArr++)
+  {
+    bool isInteger;
+    const size_t iEndNum = ScanNumber(json->str, i, json->length, &isInteger);
+    if (iEndNum == i)
+    {
+      return UNSUPPORTED_OPERATION;
     }
 
-  endLoop:
-    string_json_t result;
-    if ((status = GetWordBetweenIndexes(json, iStartNum, iEndNum, &result,
-                                        false)) != FUNC_SUCCESS)
+    status_json_t status;
+    if ((status = ReserveJsonArray(arr, iArr + 1)) != FUNC_SUCCESS)
     {
       return status;
     }
 
-    native_json_type_t baseType = GetUnderlyingType(type);
-    if (baseType == JSON_INT &&
-        (status = ConvertJsonToStandardType(
-             result, baseType, &arr->data.i[iArr++])) != FUNC_SUCCESS)
+    const char *const literal = &json->str[i];
+    switch (GetUnderlyingType(type))
     {
-      return status;
+    case JSON_DOUBLE:
+      status = ParseJsonDouble(literal, iEndNum - i, &arr->data.d[iArr]);
+      break;
+    case JSON_LONG:
+      status = ParseJsonLong(literal, iEndNum - i, &arr->data.l[iArr]);
+      break;
+    default:
+      status = ParseJsonInt(literal, iEndNum - i, &arr->data.i[iArr]);
+      break;
     }
-    else if (baseType == JSON_DOUBLE &&
-             (status = ConvertJsonToStandardType(
-                  result, baseType, &arr->data.d[iArr++])) != FUNC_SUCCESS)
+    if (status != FUNC_SUCCESS)
     {
       return status;
     }
-    else if (baseType == JSON_LONG &&
-             (status = ConvertJsonToStandardType(
-                  result, baseType, &arr->data.d[iArr++])) != FUNC_SUCCESS)
+    arr->length = iArr + 1;
+
+    // Items are separated by commas and the last one by the closing bracket
+    i = SkipWhitespace(json->str, iEndNum, json->length);
+    if (i < json->length && json->str[i] == SQUARE_CLOSE)
+    {
+      return FUNC_SUCCESS;
+    }
+    if (i >= json->length || json->str[i] != COMMA)
     {
-      return status;
+      return UNSUPPORTED_OPERATION;
     }
+    i = SkipWhitespace(json->str, i + 1, json->length);
+  }
+}
+
+static status_json_t ConvertToStandardType(const string_json_t *json,
+                                           native_json_type_t type, void *dest)
+{
+  status_json_t status;
+
+  // Scalars are parsed in place, so they are not copied or limited in length
+  switch (type)
+  {
+  case JSON_DOUBLE:
+    return ParseJsonDouble(json->str, json->length, (double *)dest);
+
+  case JSON_LONG:
+    return ParseJsonLong(json->str, json->length, (long *)dest);
+
+  case JSON_INT:
+    return ParseJsonInt(json->str, json->length, (int *)dest);
 
-    arr->length = iArr;
-    iStartNum = -1;
-    iEndNum = -1;
-    isReading = false;
+  case JSON_BOOLEAN:
+    *(bool *)dest = json->length == 4 && memcmp(json->str, "true", 4) == 0;
     break;
 
+  case JSON_DOUBLE_ARR:
+  case JSON_LONG_ARR:
+  case JSON_INT_ARR:
+    return ConvertNumberArray(json, type, (array_json_t *)dest);
+
   case JSON_CHAR_ARR:
-    if ((status = ConvertJsonToString(json, dest)) != FUNC_SUCCESS)
+    if ((status = ConvertJsonToString(*json, dest)) != FUNC_SUCCESS)
     {
       return status;
     }
@@ -489,6 +899,163 @@ status_json_t ConvertJsonToStandardType(string_json_t json,
   return FUNC_SUCCESS;
 }
 
+// Public members
+
+status_json_t ConvertJsonToString(string_json_t src, char *const dest)
+{
+  if (src.length >= JSONBUFFSIZE)
+    return MEMORY_FAILURE;
+
+  PROFILE_BEGIN();
+  memcpy(dest, src.str, src.length);
+  dest[src.length] = '\0';
+  STATS_ADD(bytesCopied, src.length);
+  PROFILE_END(convertToString);
+  return FUNC_SUCCESS;
+}
+
+status_json_t ConvertStringToJson(const char *src, string_json_t *dest)
+{
+  const size_t size = strlen(src);
+  status_json_t status;
+  if ((status = ReserveJsonString(dest, size)) != FUNC_SUCCESS)
+    return status;
+
+  PROFILE_BEGIN();
+  for (size_t i = 0; i < size; i++)
+  {
+    dest->str[i] = src[i];
+  }
+  dest->length = size;
+  STATS_ADD(bytesCopied, size);
+  PROFILE_END(convertStringToJson);
+  return FUNC_SUCCESS;
+}
+
+status_json_t ReserveJsonString(string_json_t *json, const size_t length)
+{
+  if (length >= JSONBUFFSIZE)
+    return MEMORY_FAILURE;
+
+#ifdef JSON_PROFILE_DYNAMIC
+  if (length < json->capacity)
+    return FUNC_SUCCESS;
+
+  // Doubling keeps repeated growth linear
+  const size_t capacity =
+      length + 1 > json->capacity * 2 ? length + 1 : json->capacity * 2;
+  char *str = realloc(json->str, capacity);
+  if (str == nullptr)
+    return MEMORY_FAILURE;
+  json->str = str;
+  json->capacity = capacity;
+#else
+  (void)json;
+#endif
+  return FUNC_SUCCESS;
+}
+
+void FreeJsonString(string_json_t *json)
+{
+#ifdef JSON_PROFILE_DYNAMIC
+  free(json->str);
+  json->str = nullptr;
+  json->capacity = 0;
+#endif
+  json->length = 0;
+  json->type = JUNDEFINED;
+}
+
+// Items are at most 8 bytes whatever the type, so capacity counts items of
+// the largest type
+status_json_t ReserveJsonArray(array_json_t *array, const size_t count)
+{
+  if (count > JSONBUFFSIZE)
+    return MEMORY_FAILURE;
+
+#ifdef JSON_PROFILE_DYNAMIC
+  if (count <= array->capacity)
+    return FUNC_SUCCESS;
+
+  const size_t capacity =
+      count > array->capacity * 2 ? count : array->capacity * 2;
+  void *items = realloc(array->data.d, capacity * sizeof(double));
+  if (items == nullptr)
+    return MEMORY_FAILURE;
+  array->data.d = items;
+  array->capacity = capacity;
+#else
+  (void)array;
+#endif
+  return FUNC_SUCCESS;
+}
+
+void FreeJsonArray(array_json_t *array)
+{
+#ifdef JSON_PROFILE_DYNAMIC
+  free(array->data.d);
+  array->data.d = nullptr;
+  array->capacity = 0;
+#endif
+  array->length = 0;
+}
+
+status_json_t GetJsonProperty3(string_json_t src, string_json_t *dest,
+                               const char *target)
+{
+  return FindProperty(&src, dest, target, MAX_NESTING_LEVEL);
+}
+
+status_json_t GetJsonProperty2(string_json_t *srcDest, const char *target)
+{
+  return FindProperty(srcDest, srcDest, target, MAX_NESTING_LEVEL);
+}
+
+status_json_t ProbeJsonProperty(const string_json_t *src, const char *path,
+                                json_view_t *dest)
+{
+  size_t i;
+  const status_json_t status = ScanPath(src, path, &i);
+  if (status != FUNC_SUCCESS)
+  {
+    return status;
+  }
+
+  // Only the first byte of the value is read, to tell its type
+  json_view_t view;
+  return ViewJson(&src->str[i], src->length - i,
+                  dest != nullptr ? dest : &view);
+}
+
+status_json_t ProbeJsonSpan(const string_json_t *src, const char *path,
+                            json_view_t *dest)
+{
+  status_json_t status;
+  if ((status = ProbeJsonProperty(src, path, dest)) != FUNC_SUCCESS)
+  {
+    return status;
+  }
+
+  const size_t end = SkipValue(dest->str, 0, dest->length);
+  if (end == 0)
+  {
+    return MEMORY_FAILURE;
+  }
+
+  STATS_ADD(bytesScanned, end);
+  dest->length = end;
+  return FUNC_SUCCESS;
+}
+
+status_json_t ConvertJsonToStandardType(string_json_t json,
+                                        native_json_type_t type, void *dest)
+{
+  PROFILE_BEGIN();
+  const status_json_t status = ConvertToStandardType(&json, type, dest);
+  PROFILE_END(convertToStandardType);
+  return status;
+}
+
 void GetStatusErrorMessage(status_json_t status, char *dest)
 {
   switch (status)
@@ -499,6 +1066,8 @@ void GetStatusErrorMessage(status_json_t status, char *dest)
   case UNDEFINED_KEY:
   case UNSUPPORTED_OPERATION:
   case MEMORY_FAILURE:
+  case INVALID_NUMBER:
+  case NUMBER_OUT_OF_RANGE:
     snprintf(dest, BUFSIZ, "Function exited with failure code %d", status);
     break;
   }
@@ -507,95 +1076,252 @@ void GetStatusErrorMessage(status_json_t status, char *dest)
 char *MapStringArray(void (*func)(char *, size_t, void *),
                      const char *const buffer, void *data, const size_t max)
 {
-  if (max <= 3)
-  {
+#ifdef JSON_PROFILE_DYNAMIC
+  // An item is never longer than the buffer it is in
+  string_json_t scratch = {};
+  if (ReserveJsonString(&scratch, max) == FUNC_SUCCESS)
+    MapArray(func, buffer, data, max, scratch.str);
+  FreeJsonString(&scratch);
+  return nullptr;
+#else
+  char tempBuff[JSONBUFFSIZE];
+  return MapArray(func, buffer, data, max, tempBuff);
+#endif
+}
+
+void InitJsonParser(json_parser_t *parser)
+{
+#ifdef JSON_PROFILE_DYNAMIC
+  parser->scratch.str = nullptr;
+  parser->scratch.capacity = 0;
+#endif
+  parser->scratch.length = 0;
+  parser->scratch.type = JUNDEFINED;
+  parser->maxDepth = MAX_NESTING_LEVEL;
+}
+
+void FreeJsonParser(json_parser_t *parser)
+{
+  FreeJsonString(&parser->scratch);
+}
+
+status_json_t ParserGetProperty(json_parser_t *parser, const string_json_t *src,
+                                string_json_t *dest, const char *target)
+{
+  // The nesting bitmap of the scan holds MAX_NESTING_LEVEL levels at most
+  const size_t maxDepth = parser->maxDepth < MAX_NESTING_LEVEL
+                              ? parser->maxDepth
+                              : MAX_NESTING_LEVEL;
+  return FindProperty(src, dest, target, maxDepth);
+}
+
+char *ParserMapStringArray(json_parser_t *parser,
+                           void (*func)(char *, size_t, void *),
+                           const char *const buffer, void *data,
+                           const size_t max)
+{
+#ifdef JSON_PROFILE_DYNAMIC
+  if (ReserveJsonString(&parser->scratch, max) != FUNC_SUCCESS)
     return nullptr;
-  }
+#endif
+  return MapArray(func, buffer, data, max, parser->scratch.str);
+}
 
-  size_t i = 1, items = 0;
-  char c = buffer[i];
-  const type_json_t type = GetJSONType(c);
-  ssize_t startIndex = -1, endIndex = -1;
-  char tempBuff[JSONBUFFSIZE];
-  bool betweenQuotes = false;
-  while (c != '\0' && i <= max - 2)
+void InitJsonCache(json_cache_t *cache)
+{
+  memset(cache, 0, sizeof(json_cache_t));
+}
+
+status_json_t CachedGetProperty(json_cache_t *cache, const string_json_t *src,
+                                string_json_t *dest, const char *target)
+{
+  const size_t targetLength = strlen(target);
+  size_t iBegin, iEnd;
+  status_json_t status;
+  if (targetLength >= JSONCACHEKEYSIZE ||
+      !IsPredictableKey(target, targetLength))
+  {
+    return FindProperty(src, dest, target, MAX_NESTING_LEVEL);
+  }
+  if ((status = FindObjectBounds(src, &iBegin, &iEnd)) != FUNC_SUCCESS)
   {
-    c = buffer[i];
+    return status;
+  }
+
+  const unsigned long long keyHash = HashBytes(target, targetLength);
+  bool isHit;
+  BindCache(cache, src);
+  cache_entry_json_t *entry = FindCacheEntry(cache, target, keyHash, &isHit);
 
-    if (type != JSTRING && c == '"')
+  // The same address and length do not mean the same content, so a cached
+  // offset is only used while the key is still found there
+  size_t iKey;
+  if (isHit && IsKeyAt(src, entry->offset, iBegin, iEnd, target, targetLength))
+  {
+    cache->hits++;
+    iKey = entry->offset;
+  }
+  else
+  {
+    cache->misses++;
+    PROFILE_BEGIN();
+    status = ScanKey(src, iBegin, iEnd, target, targetLength, MAX_NESTING_LEVEL,
+                     &iKey);
+    PROFILE_END(getProperty);
+    // Missing keys cannot be confirmed without a scan, so they are not kept
+    if (status != FUNC_SUCCESS)
     {
-      betweenQuotes = !betweenQuotes;
+      return status;
     }
+    iKey -= targetLength + 1;
 
-    switch (type)
-    {
-    default:
-    case JSTRING:
+    memcpy(entry->key, target, targetLength + 1);
+    entry->keyHash = keyHash;
+    entry->offset = iKey;
+    entry->isUsed = true;
+  }
+
+  value_span_t span;
+  if ((status = FindValue(src, iKey + targetLength + 1, iEnd, &span)) ==
+      FUNC_SUCCESS)
+  {
+    status = CopySpan(src, &span, dest);
+  }
+
+  // Writing the result over the document changes its content
+  if (dest == src)
+  {
+    InvalidateJsonCache(cache);
+  }
+  return status;
+}
+
+void InvalidateJsonCache(json_cache_t *cache)
+{
+  for (size_t i = 0; i < JSONCACHESIZE; i++)
+  {
+    cache->entries[i].isUsed = false;
+  }
+  cache->document = nullptr;
+  cache->invalidations++;
+}
+
+void InitJsonPredictor(json_predictor_t *predictor)
+{
+  memset(predictor, 0, sizeof(json_predictor_t));
+}
+
+status_json_t PredictedGetProperty(json_predictor_t *predictor,
+                                   const string_json_t *src,
+                                   string_json_t *dest, const char *target)
+{
+  const size_t targetLength = strlen(target);
+  size_t iBegin, iEnd;
+  status_json_t status;
+  if (targetLength >= JSONCACHEKEYSIZE ||
+      !IsPredictableKey(target, targetLength))
+  {
+    return FindProperty(src, dest, target, MAX_NESTING_LEVEL);
+  }
+  if ((status = FindObjectBounds(src, &iBegin, &iEnd)) != FUNC_SUCCESS)
+  {
+    return status;
+  }
+
+  const unsigned long long keyHash = HashBytes(target, targetLength);
+  bool isHit;
+  prediction_entry_json_t *entry =
+      BindRecord(predictor, src, target, keyHash, &isHit);
+  const size_t ordinal = predictor->ordinal++;
+  const size_t iAfterPrevious =
+      ordinal > 0 ? SkipToNextKey(src, predictor->end, iEnd) : 0;
+
+  // The key is where it was last time, or else right after the value of the
+  // lookup before it if it was there last time
+  size_t iKey = 0;
+  bool isPredicted = false;
+  if (isHit)
+  {
+    if (IsKeyAt(src, entry->offset, iBegin, iEnd, target, targetLength))
     {
-      if (c == '"' && i - 1 > 0 && buffer[i - 1] != '\\')
-      {
-        if (startIndex < 0)
-        {
-          startIndex = i;
-        }
-        else
-        {
-          endIndex = i;
-          goto endLoop;
-        }
-      }
-      break;
+      iKey = entry->offset;
+      isPredicted = true;
     }
-    case JOBJECT:
+    else if (entry->isAdjacent && entry->ordinal == ordinal && ordinal > 0 &&
+             IsKeyAt(src, iAfterPrevious, iBegin, iEnd, target, targetLength))
     {
-      if (betweenQuotes)
-      {
-        break;
-      }
-
-      if (c == '{' && startIndex < 0)
-      {
-        startIndex = i - 1;
-      }
-      else if (c == '}')
-      {
-        endIndex = i + 1;
-        goto endLoop;
-      }
-      break;
+      iKey = iAfterPrevious;
+      isPredicted = true;
     }
-    case JARRAY:
-    {
-      if (betweenQuotes)
-      {
-        break;
-      }
+  }
 
-      if (c == '[' && startIndex < 0)
-      {
-        startIndex = i - 1;
-      }
-      else if (c == ']')
-      {
-        endIndex = i + 1;
-        goto endLoop;
-      }
-      break;
-    }
+  if (isPredicted)
+  {
+    predictor->hits++;
+    STATS_ADD(keysPredicted, 1);
+  }
+  else
+  {
+    predictor->misses++;
+    STATS_ADD(keysMispredicted, 1);
+    PROFILE_BEGIN();
+    status = ScanKey(src, iBegin, iEnd, target, targetLength, MAX_NESTING_LEVEL,
+                     &iKey);
+    PROFILE_END(getProperty);
+    if (status != FUNC_SUCCESS)
+    {
+      return status;
     }
+    iKey -= targetLength + 1;
+  }
 
-    i++;
-    continue;
-
-  endLoop:
-    startIndex++;
-    memcpy(tempBuff, &buffer[startIndex], endIndex - startIndex);
-    tempBuff[endIndex - startIndex] = '\0';
-    func(tempBuff, items++, data);
-    startIndex = -1;
-    endIndex = -1;
-    i++;
+  value_span_t span;
+  if ((status = FindValue(src, iKey + targetLength + 1, iEnd, &span)) !=
+      FUNC_SUCCESS)
+  {
+    return status;
   }
 
-  return nullptr;
+  memcpy(entry->key, target, targetLength + 1);
+  entry->keyHash = keyHash;
+  entry->offset = iKey;
+  entry->ordinal = ordinal;
+  entry->isAdjacent = ordinal > 0 && iKey == iAfterPrevious;
+  entry->record = predictor->records;
+  entry->isUsed = true;
+  predictor->end =
+      span.offset + span.length + (span.type == JSTRING ? 1 : 0);
+
+  return CopySpan(src, &span, dest);
+}
+
+status_json_t GetJsonStats(stats_json_t *dest)
+{
+#ifdef JSON_STATS
+  *dest = stats;
+  return FUNC_SUCCESS;
+#else
+  (void)dest;
+  return UNSUPPORTED_OPERATION;
+#endif
+}
+
+void ResetJsonStats()
+{
+#ifdef JSON_STATS
+  stats = (stats_json_t){};
+#endif
+}
+
+status_json_t SetJsonProfileHook(profile_hook_json_t hook, void *data)
+{
+#ifdef JSON_STATS
+  profileHook = hook;
+  profileHookData = data;
+  return FUNC_SUCCESS;
+#else
+  (void)hook;
+  (void)data;
+  return UNSUPPORTED_OPERATION;
+#endif
 }
@@ -0,0 +1,167 @@
+#include "json_internal.h"
+
+// Columnar extraction: an array of homogeneous objects is walked once with a
+// view cursor and every requested member is decoded straight into its column.
+// Members that no column asks for are skipped without being decoded
+
+// Private members
+
+static void ClearCell(const column_json_t *column, const size_t row)
+{
+  switch (column->type)
+  {
+  case JSON_DOUBLE:
+    ((double *)column->data)[row] = 0;
+    break;
+  case JSON_LONG:
+    ((long *)column->data)[row] = 0;
+    break;
+  case JSON_INT:
+    ((int *)column->data)[row] = 0;
+    break;
+  default:
+    ((bool *)column->data)[row] = false;
+    break;
+  }
+
+  if (column->isPresent != nullptr)
+    column->isPresent[row] = false;
+}
+
+static status_json_t ReadCell(const column_json_t *column, const size_t row,
+                              json_view_t value)
+{
+  if (value.type == JNULL)
+  {
+    ClearCell(column, row);
+    return FUNC_SUCCESS;
+  }
+
+  bool isInteger;
+  const size_t end = value.type == JNUMBER
+                         ? ScanNumber(value.str, 0, value.length, &isInteger)
+                         : 0;
+  status_json_t status;
+  switch (column->type)
+  {
+  case JSON_DOUBLE:
+    status = end == 0 ? UNSUPPORTED_OPERATION
+                      : ParseJsonDouble(value.str, end,
+                                        &((double *)column->data)[row]);
+    break;
+  case JSON_LONG:
+    status = end == 0
+                 ? UNSUPPORTED_OPERATION
+                 : ParseJsonLong(value.str, end, &((long *)column->data)[row]);
+    break;
+  case JSON_INT:
+    status = end == 0
+                 ? UNSUPPORTED_OPERATION
+                 : ParseJsonInt(value.str, end, &((int *)column->data)[row]);
+    break;
+  default:
+    status = ViewGetBoolean(value, &((bool *)column->data)[row]);
+    break;
+  }
+
+  if (status == FUNC_SUCCESS && column->isPresent != nullptr)
+    column->isPresent[row] = true;
+  return status;
+}
+
+// Homogeneous objects list their members in the same order, so the search
+// starts at the column after the one matched last. Keys are compared as
+// written, without their double quotes. Returns count if no column matches
+static size_t FindColumn(const column_json_t *columns,
+                         const size_t *keyLengths, const size_t count,
+                         const json_view_t *key, size_t *hint)
+{
+  const size_t length = key->length - 2;
+  for (size_t n = 0; n < count; n++)
+  {
+    const size_t i = (*hint + n) % count;
+    if (keyLengths[i] == length &&
+        memcmp(columns[i].key, &key->str[1], length) == 0)
+    {
+      *hint = i + 1;
+      return i;
+    }
+  }
+  return count;
+}
+
+// Public members
+
+status_json_t ExtractJsonColumns(json_view_t array,
+                                 const column_json_t *columns,
+                                 const size_t count, const size_t capacity,
+                                 size_t *rows)
+{
+  if (count > JSONMAXCOLUMNS)
+    return UNSUPPORTED_OPERATION;
+
+  size_t keyLengths[JSONMAXCOLUMNS];
+  for (size_t i = 0; i < count; i++)
+  {
+    keyLengths[i] = strlen(columns[i].key);
+    switch (columns[i].type)
+    {
+    case JSON_DOUBLE:
+    case JSON_LONG:
+    case JSON_INT:
+    case JSON_BOOLEAN:
+      break;
+    default:
+      return UNSUPPORTED_OPERATION;
+    }
+  }
+
+  json_cursor_t items, members;
+  json_view_t item, key, value;
+  status_json_t status;
+  if (array.type != JARRAY || ViewIterate(array, &items) != FUNC_SUCCESS)
+    return UNSUPPORTED_OPERATION;
+
+  const unsigned long long isComplete =
+      count == JSONMAXCOLUMNS ? ~0ULL : (1ULL << count) - 1;
+  size_t row = 0, hint = 0;
+  *rows = 0;
+  while ((status = ViewNextItem(&items, &item)) == FUNC_SUCCESS)
+  {
+    if (row >= capacity)
+      return MEMORY_FAILURE;
+    if (item.type != JOBJECT || ViewIterate(item, &members) != FUNC_SUCCESS)
+      return UNSUPPORTED_OPERATION;
+
+    for (size_t i = 0; i < count; i++)
+      ClearCell(&columns[i], row);
+
+    // One bit per column read in this row; The first of duplicate keys wins
+    // like with ViewGetField, and the rest of the item is skipped as soon as
+    // every column has been read
+    unsigned long long isRead = 0;
+    while (isRead != isComplete &&
+           (status = ViewNextField(&members, &key, &value)) == FUNC_SUCCESS)
+    {
+      const size_t i = FindColumn(columns, keyLengths, count, &key, &hint);
+      if (i == count || (isRead & (1ULL << i)))
+        continue;
+      if ((status = ReadCell(&columns[i], row, value)) != FUNC_SUCCESS)
+        return status;
+      isRead |= 1ULL << i;
+    }
+
+    // A member cursor that ran to the end stopped on the closing brace, so the
+    // item does not have to be skipped a second time
+    if (isRead != isComplete)
+    {
+      if (status != UNDEFINED_KEY)
+        return status;
+      items.position = item.str - items.str + members.position + 1;
+      items.isPending = false;
+    }
+    *rows = ++row;
+  }
+
+  return status == UNDEFINED_KEY ? FUNC_SUCCESS : status;
+}
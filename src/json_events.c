@@ -0,0 +1,179 @@
+#include "json_internal.h"
+
+// Event interface: the document is walked once, token by token, and every
+// token is handed to the handler as a view into the text. Nothing is copied
+// and the only state is one bit per nesting level, so memory use is the same
+// for a kilobyte and for a memory-mapped file of several gigabytes
+
+// Private members
+
+typedef enum : char
+{
+  // A value, as the root or after a colon or a comma in an array
+  EXPECT_VALUE,
+  // A value or the end of the array, right after the opening bracket
+  EXPECT_FIRST_VALUE,
+  // A key, after a comma in an object
+  EXPECT_KEY,
+  // A key or the end of the object, right after the opening brace
+  EXPECT_FIRST_KEY,
+  // A comma or the end of the container, or the end of the text at the root
+  EXPECT_SEPARATOR
+} event_state_t;
+
+static bool Emit(const event_handler_json_t *handler,
+                 const event_callback_json_t callback, const char *str,
+                 const size_t length, const type_json_t type,
+                 const size_t depth)
+{
+  if (callback == nullptr)
+    return true;
+
+  const json_view_t view = {str, length, type};
+  return callback(view, depth, handler->data);
+}
+
+static bool IsObjectLevel(const unsigned char *objectLevels, const size_t depth)
+{
+  return objectLevels[depth / CHAR_BIT] >> depth % CHAR_BIT & 1;
+}
+
+// Returns the index one past the literal true, false or null at str[i], or i
+// if there is none
+static size_t ScanLiteral(const char *str, const size_t i, const size_t length,
+                          type_json_t *type)
+{
+  static const char *const LITERALS[] = {"true", "false", "null"};
+  *type = JUNDEFINED;
+  for (size_t n = 0; n < 3; n++)
+  {
+    const size_t literalLength = strlen(LITERALS[n]);
+    if (length - i >= literalLength &&
+        memcmp(&str[i], LITERALS[n], literalLength) == 0)
+    {
+      *type = n < 2 ? JBOOLEAN : JNULL;
+      return i + literalLength;
+    }
+  }
+  return i;
+}
+
+// Public members
+
+status_json_t ParseJsonEvents(const char *src, const size_t length,
+                              const event_handler_json_t *handler)
+{
+  // One bit per nesting level remembers whether that container is an object
+  unsigned char objectLevels[MAX_NESTING_LEVEL / CHAR_BIT] = {0};
+  event_state_t state = EXPECT_VALUE;
+  size_t depth = 0;
+  size_t i = 0;
+  while ((i = SkipWhitespace(src, i, length)) < length)
+  {
+    const char c = src[i];
+    const bool isObject = depth > 0 && IsObjectLevel(objectLevels, depth - 1);
+
+    // Closing the innermost container
+    if ((state == EXPECT_SEPARATOR || state == EXPECT_FIRST_KEY ||
+         state == EXPECT_FIRST_VALUE) &&
+        depth > 0 && c == (isObject ? CURLY_CLOSE : SQUARE_CLOSE))
+    {
+      depth--;
+      state = EXPECT_SEPARATOR;
+      if (!Emit(handler,
+                isObject ? handler->onEndObject : handler->onEndArray,
+                &src[i], 1, isObject ? JOBJECT : JARRAY, depth))
+      {
+        return FUNC_SUCCESS;
+      }
+      i++;
+      continue;
+    }
+
+    size_t end;
+    switch (state)
+    {
+    case EXPECT_SEPARATOR:
+      if (depth == 0 || c != COMMA)
+        return UNSUPPORTED_OPERATION;
+      state = isObject ? EXPECT_KEY : EXPECT_VALUE;
+      i++;
+      continue;
+
+    case EXPECT_KEY:
+    case EXPECT_FIRST_KEY:
+      if (c != DOUBLE_QUOTES || (end = SkipString(src, i, length)) == i)
+        return UNSUPPORTED_OPERATION;
+      if (!Emit(handler, handler->onKey, &src[i], end - i, JSTRING, depth))
+        return FUNC_SUCCESS;
+
+      i = SkipWhitespace(src, end, length);
+      if (i >= length || src[i] != COLON)
+        return UNSUPPORTED_OPERATION;
+      state = EXPECT_VALUE;
+      i++;
+      continue;
+
+    default:
+      break;
+    }
+
+    // A value, either a scalar or the start of a container
+    if (c == CURLY_OPEN || c == SQUARE_OPEN)
+    {
+      if (depth >= MAX_NESTING_LEVEL)
+        return UNSUPPORTED_OPERATION;
+
+      const bool isOpeningObject = c == CURLY_OPEN;
+      if (isOpeningObject)
+        objectLevels[depth / CHAR_BIT] |= 1u << depth % CHAR_BIT;
+      else
+        objectLevels[depth / CHAR_BIT] &= ~(1u << depth % CHAR_BIT);
+
+      if (!Emit(handler,
+                isOpeningObject ? handler->onStartObject
+                                : handler->onStartArray,
+                &src[i], length - i, isOpeningObject ? JOBJECT : JARRAY,
+                depth))
+      {
+        return FUNC_SUCCESS;
+      }
+      depth++;
+      state = isOpeningObject ? EXPECT_FIRST_KEY : EXPECT_FIRST_VALUE;
+      i++;
+      continue;
+    }
+
+    type_json_t type;
+    event_callback_json_t callback;
+    bool isInteger;
+    if (c == DOUBLE_QUOTES)
+    {
+      end = SkipString(src, i, length);
+      type = JSTRING;
+      callback = handler->onString;
+    }
+    else if (c == MINUS || isdigit((unsigned char)c))
+    {
+      end = ScanNumber(src, i, length, &isInteger);
+      type = JNUMBER;
+      callback = handler->onNumber;
+    }
+    else
+    {
+      end = ScanLiteral(src, i, length, &type);
+      callback = type == JNULL ? handler->onNull : handler->onBoolean;
+    }
+
+    if (end == i)
+      return UNSUPPORTED_OPERATION;
+    if (!Emit(handler, callback, &src[i], end - i, type, depth))
+      return FUNC_SUCCESS;
+    state = EXPECT_SEPARATOR;
+    i = end;
+  }
+
+  // Anything but a complete root value is truncated
+  return state == EXPECT_SEPARATOR && depth == 0 ? FUNC_SUCCESS
+                                                 : UNSUPPORTED_OPERATION;
+}
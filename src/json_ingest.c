@@ -0,0 +1,531 @@
+#define _DEFAULT_SOURCE
+#include "json_internal.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#define JSON_HAS_URING
+#endif
+
+// Ingestion pipeline: the calling thread is the I/O stage. It fills free
+// buffers from the pool and queues them for the workers, which run the
+// callback and hand the buffers back. The queue holds at most one entry per
+// buffer, so reading never gets more than countBuffers files ahead. Without
+// io_uring, a pool of reader threads shares the I/O stage with blocking reads
+
+// Private members
+
+typedef struct
+{
+  size_t path;
+  size_t length;
+  // Size of a regular file, or 0 when it is only known at end of file
+  size_t expected;
+  int fd;
+  status_json_t status;
+} slot_t;
+
+typedef struct
+{
+  const char *const *paths;
+  size_t countPaths;
+  const ingest_options_json_t *options;
+  pthread_mutex_t lock;
+  pthread_cond_t isReady;
+  pthread_cond_t isFree;
+  slot_t slots[JSONMAXBUFFERS];
+  size_t freeSlots[JSONMAXBUFFERS];
+  size_t countFree;
+  size_t readySlots[JSONMAXBUFFERS];
+  size_t readyHead;
+  size_t countReady;
+  // First path not yet taken by a reader
+  size_t next;
+  bool isDone;
+} pipeline_t;
+
+static char *GetBuffer(const pipeline_t *pipeline, const size_t slot)
+{
+  return &pipeline->options->buffers[slot * pipeline->options->bufferSize];
+}
+
+static void *RunWorker(void *data)
+{
+  pipeline_t *pipeline = (pipeline_t *)data;
+  const ingest_options_json_t *options = pipeline->options;
+
+  pthread_mutex_lock(&pipeline->lock);
+  for (;;)
+  {
+    while (pipeline->countReady == 0 && !pipeline->isDone)
+      pthread_cond_wait(&pipeline->isReady, &pipeline->lock);
+    if (pipeline->countReady == 0)
+      break;
+
+    const size_t i = pipeline->readySlots[pipeline->readyHead];
+    pipeline->readyHead = (pipeline->readyHead + 1) % options->countBuffers;
+    pipeline->countReady--;
+    pthread_mutex_unlock(&pipeline->lock);
+
+    const slot_t *slot = &pipeline->slots[i];
+    options->callback(pipeline->paths[slot->path], GetBuffer(pipeline, i),
+                      slot->length, slot->status, options->data);
+
+    pthread_mutex_lock(&pipeline->lock);
+    pipeline->freeSlots[pipeline->countFree++] = i;
+    pthread_cond_signal(&pipeline->isFree);
+  }
+  pthread_mutex_unlock(&pipeline->lock);
+  return nullptr;
+}
+
+// Returns a free buffer, or SIZE_MAX if there is none and isWaiting is false
+static size_t AcquireSlot(pipeline_t *pipeline, const bool isWaiting)
+{
+  size_t i = SIZE_MAX;
+  pthread_mutex_lock(&pipeline->lock);
+  while (isWaiting && pipeline->countFree == 0)
+    pthread_cond_wait(&pipeline->isFree, &pipeline->lock);
+  if (pipeline->countFree > 0)
+    i = pipeline->freeSlots[--pipeline->countFree];
+  pthread_mutex_unlock(&pipeline->lock);
+  return i;
+}
+
+static void PublishSlot(pipeline_t *pipeline, const size_t i)
+{
+  slot_t *slot = &pipeline->slots[i];
+  if (slot->fd >= 0)
+  {
+    close(slot->fd);
+    slot->fd = -1;
+  }
+  GetBuffer(pipeline, i)[slot->length] = '\0';
+
+  const size_t capacity = pipeline->options->countBuffers;
+  pthread_mutex_lock(&pipeline->lock);
+  pipeline->readySlots[(pipeline->readyHead + pipeline->countReady) %
+                       capacity] = i;
+  pipeline->countReady++;
+  pthread_cond_signal(&pipeline->isReady);
+  pthread_mutex_unlock(&pipeline->lock);
+}
+
+// Opens the file of a slot. Returns false if the slot already failed
+static bool OpenSlot(pipeline_t *pipeline, const size_t i, const size_t path)
+{
+  slot_t *slot = &pipeline->slots[i];
+  struct stat info;
+  slot->path = path;
+  slot->length = 0;
+  slot->expected = 0;
+  slot->status = FUNC_SUCCESS;
+  if ((slot->fd = open(pipeline->paths[path], O_RDONLY | O_CLOEXEC)) < 0 ||
+      fstat(slot->fd, &info) != 0)
+  {
+    slot->status = UNSUPPORTED_OPERATION;
+    return false;
+  }
+
+  if (S_ISREG(info.st_mode))
+  {
+    if ((size_t)info.st_size >= pipeline->options->bufferSize)
+    {
+      slot->status = MEMORY_FAILURE;
+      return false;
+    }
+    slot->expected = info.st_size;
+  }
+  return true;
+}
+
+// Reads the rest of the file of a slot, up to the end of its buffer. Regular
+// files are read by offset since the ring does not move the file position
+static void ReadSlot(pipeline_t *pipeline, const size_t i)
+{
+  slot_t *slot = &pipeline->slots[i];
+  char *buffer = GetBuffer(pipeline, i);
+  const size_t capacity = pipeline->options->bufferSize - 1;
+  ssize_t n;
+  while (slot->length < capacity &&
+         (n = slot->expected > 0
+                  ? pread(slot->fd, &buffer[slot->length],
+                          capacity - slot->length, slot->length)
+                  : read(slot->fd, &buffer[slot->length],
+                         capacity - slot->length)) != 0)
+  {
+    if (n < 0)
+    {
+      slot->status = UNSUPPORTED_OPERATION;
+      return;
+    }
+    slot->length += n;
+  }
+
+  // A full buffer is only an error if there is more to read
+  char extra;
+  if (slot->length == capacity && slot->expected == 0 &&
+      read(slot->fd, &extra, 1) != 0)
+  {
+    slot->status = MEMORY_FAILURE;
+  }
+}
+
+static void *RunReader(void *data)
+{
+  pipeline_t *pipeline = (pipeline_t *)data;
+  for (;;)
+  {
+    pthread_mutex_lock(&pipeline->lock);
+    const size_t path = pipeline->next < pipeline->countPaths
+                            ? pipeline->next++
+                            : SIZE_MAX;
+    pthread_mutex_unlock(&pipeline->lock);
+    if (path == SIZE_MAX)
+      break;
+
+    const size_t i = AcquireSlot(pipeline, true);
+    if (OpenSlot(pipeline, i, path))
+      ReadSlot(pipeline, i);
+    PublishSlot(pipeline, i);
+  }
+  return nullptr;
+}
+
+// Reads the paths from next on with blocking reads, on the calling thread and
+// up to countReaders - 1 more. Readers that cannot be started are not needed,
+// since the calling thread reads until every path is taken
+static void RunBlocking(pipeline_t *pipeline, const size_t next)
+{
+  const ingest_options_json_t *options = pipeline->options;
+  size_t maxReaders = options->countReaders > 0 ? options->countReaders
+                                                : options->countBuffers;
+  if (maxReaders > pipeline->countPaths - next)
+    maxReaders = pipeline->countPaths - next;
+
+  pipeline->next = next;
+  pthread_t readers[JSONMAXWORKERS];
+  size_t countReaders = 0;
+  while (countReaders + 1 < maxReaders &&
+         pthread_create(&readers[countReaders], nullptr, RunReader,
+                        pipeline) == 0)
+  {
+    countReaders++;
+  }
+
+  RunReader(pipeline);
+  for (size_t t = 0; t < countReaders; t++)
+    pthread_join(readers[t], nullptr);
+}
+
+#ifdef JSON_HAS_URING
+
+typedef struct
+{
+  int fd;
+  unsigned *sqTail;
+  unsigned *sqMask;
+  unsigned *sqArray;
+  unsigned *cqHead;
+  unsigned *cqTail;
+  unsigned *cqMask;
+  struct io_uring_sqe *sqes;
+  struct io_uring_cqe *cqes;
+  void *sqRing;
+  void *cqRing;
+  size_t sqRingSize;
+  size_t cqRingSize;
+  size_t sqesSize;
+  // Reads queued but not yet submitted
+  unsigned pending;
+  // Reads submitted whose completion has not been reaped yet
+  unsigned submitted;
+} ring_t;
+
+static void CloseRing(ring_t *ring)
+{
+  if (ring->sqes != MAP_FAILED)
+    munmap(ring->sqes, ring->sqesSize);
+  if (ring->cqRing != MAP_FAILED && ring->cqRing != ring->sqRing)
+    munmap(ring->cqRing, ring->cqRingSize);
+  if (ring->sqRing != MAP_FAILED)
+    munmap(ring->sqRing, ring->sqRingSize);
+  close(ring->fd);
+}
+
+// Sets up a ring with one submission entry per buffer. Fails on kernels
+// without io_uring or where it is disabled
+static bool OpenRing(ring_t *ring, const unsigned entries)
+{
+  struct io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  if ((ring->fd = syscall(__NR_io_uring_setup, entries, &params)) < 0)
+    return false;
+
+  ring->sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  ring->cqRingSize =
+      params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+  ring->sqesSize = params.sq_entries * sizeof(struct io_uring_sqe);
+  const bool isSingleMap = params.features & IORING_FEAT_SINGLE_MMAP;
+  if (isSingleMap && ring->cqRingSize > ring->sqRingSize)
+    ring->sqRingSize = ring->cqRingSize;
+
+  ring->sqRing = mmap(nullptr, ring->sqRingSize, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQ_RING);
+  ring->cqRing = isSingleMap
+                     ? ring->sqRing
+                     : mmap(nullptr, ring->cqRingSize, PROT_READ | PROT_WRITE,
+                            MAP_SHARED | MAP_POPULATE, ring->fd,
+                            IORING_OFF_CQ_RING);
+  ring->sqes = mmap(nullptr, ring->sqesSize, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQES);
+  if (ring->sqRing == MAP_FAILED || ring->cqRing == MAP_FAILED ||
+      ring->sqes == MAP_FAILED)
+  {
+    CloseRing(ring);
+    return false;
+  }
+
+  unsigned char *sq = ring->sqRing, *cq = ring->cqRing;
+  ring->sqTail = (unsigned *)&sq[params.sq_off.tail];
+  ring->sqMask = (unsigned *)&sq[params.sq_off.ring_mask];
+  ring->sqArray = (unsigned *)&sq[params.sq_off.array];
+  ring->cqHead = (unsigned *)&cq[params.cq_off.head];
+  ring->cqTail = (unsigned *)&cq[params.cq_off.tail];
+  ring->cqMask = (unsigned *)&cq[params.cq_off.ring_mask];
+  ring->cqes = (struct io_uring_cqe *)&cq[params.cq_off.cqes];
+  ring->pending = 0;
+  ring->submitted = 0;
+  return true;
+}
+
+// Longest single read, which has a 32-bit length
+constexpr size_t MAX_READ_SIZE = 1 << 30;
+
+// Queues a read of the rest of the file of a slot, tagged with the slot
+static void QueueRead(ring_t *ring, pipeline_t *pipeline, const size_t i)
+{
+  const slot_t *slot = &pipeline->slots[i];
+  const size_t remaining = slot->expected - slot->length;
+  const unsigned tail = *ring->sqTail;
+  const unsigned index = tail & *ring->sqMask;
+  struct io_uring_sqe *sqe = &ring->sqes[index];
+  memset(sqe, 0, sizeof(*sqe));
+  sqe->opcode = IORING_OP_READ;
+  sqe->fd = slot->fd;
+  sqe->addr = (uintptr_t)&GetBuffer(pipeline, i)[slot->length];
+  sqe->len = remaining < MAX_READ_SIZE ? remaining : MAX_READ_SIZE;
+  sqe->off = slot->length;
+  sqe->user_data = i;
+  ring->sqArray[index] = index;
+
+  // The kernel must see the entry before the new tail
+  __atomic_store_n(ring->sqTail, tail + 1, __ATOMIC_RELEASE);
+  ring->pending++;
+}
+
+// Submits the queued reads and waits for at least one of them to complete
+static bool SubmitAndWait(ring_t *ring)
+{
+  long submitted;
+  while ((submitted = syscall(__NR_io_uring_enter, ring->fd, ring->pending, 1,
+                              IORING_ENTER_GETEVENTS, nullptr, 0)) < 0)
+  {
+    if (errno != EINTR)
+      return false;
+  }
+  ring->pending -= submitted;
+  ring->submitted += submitted;
+  return true;
+}
+
+// Handles the completed reads. Short reads are queued again if isRequeuing is
+// set and otherwise left to be finished with a blocking read. Returns the
+// number of files that were finished
+static size_t ReapRing(ring_t *ring, pipeline_t *pipeline,
+                       const bool isRequeuing)
+{
+  size_t countFinished = 0;
+  unsigned head = *ring->cqHead;
+  const unsigned tail = __atomic_load_n(ring->cqTail, __ATOMIC_ACQUIRE);
+  for (; head != tail; head++)
+  {
+    const struct io_uring_cqe *cqe = &ring->cqes[head & *ring->cqMask];
+    const size_t i = cqe->user_data;
+    slot_t *slot = &pipeline->slots[i];
+    ring->submitted--;
+    if (cqe->res == -EINVAL || cqe->res == -EOPNOTSUPP)
+    {
+      // Kernels before 5.6 have no IORING_OP_READ
+      ReadSlot(pipeline, i);
+    }
+    else if (cqe->res < 0)
+    {
+      slot->status = UNSUPPORTED_OPERATION;
+    }
+    else if (cqe->res > 0 && (slot->length += cqe->res) < slot->expected)
+    {
+      // Short read, the rest goes into the next submission
+      if (isRequeuing)
+        QueueRead(ring, pipeline, i);
+      continue;
+    }
+    PublishSlot(pipeline, i);
+    countFinished++;
+  }
+  __atomic_store_n(ring->cqHead, head, __ATOMIC_RELEASE);
+  return countFinished;
+}
+
+// Waits until the kernel is done with every submitted read, so that no late
+// completion can write into a buffer that has been handed to another file.
+// Reads that were queued but never submitted are not touched by the kernel
+static void DrainRing(ring_t *ring, pipeline_t *pipeline)
+{
+  while (ring->submitted > 0)
+  {
+    if (ReapRing(ring, pipeline, false) > 0 || ring->submitted == 0)
+      continue;
+
+    // Completions are posted to the shared ring even if waiting fails
+    if (syscall(__NR_io_uring_enter, ring->fd, 0, 1, IORING_ENTER_GETEVENTS,
+                nullptr, 0) < 0 &&
+        errno != EINTR)
+    {
+      usleep(1000);
+    }
+  }
+}
+
+// Regular files are read through the ring, everything else with blocking
+// reads. Returns the number of reads that were in flight when the ring failed
+static size_t RunRing(pipeline_t *pipeline, ring_t *ring, size_t *next)
+{
+  size_t inFlight = 0;
+  while (*next < pipeline->countPaths || inFlight > 0)
+  {
+    // Starts a read for every free buffer, without waiting for one
+    size_t i;
+    while (*next < pipeline->countPaths &&
+           (i = AcquireSlot(pipeline, inFlight == 0)) != SIZE_MAX)
+    {
+      if (!OpenSlot(pipeline, i, (*next)++))
+      {
+        PublishSlot(pipeline, i);
+      }
+      else if (pipeline->slots[i].expected == 0)
+      {
+        ReadSlot(pipeline, i);
+        PublishSlot(pipeline, i);
+      }
+      else
+      {
+        QueueRead(ring, pipeline, i);
+        inFlight++;
+      }
+    }
+    if (inFlight == 0)
+      continue;
+
+    if (!SubmitAndWait(ring))
+      return inFlight;
+    inFlight -= ReapRing(ring, pipeline, true);
+  }
+  return 0;
+}
+
+#endif
+
+// Public members
+
+status_json_t IngestJsonFiles(const char *const *paths, const size_t count,
+                              const ingest_options_json_t *options)
+{
+  if (options->callback == nullptr || options->buffers == nullptr ||
+      options->countBuffers == 0 || options->countBuffers > JSONMAXBUFFERS ||
+      options->bufferSize == 0 || options->countWorkers == 0 ||
+      options->countWorkers > JSONMAXWORKERS ||
+      options->countReaders > JSONMAXWORKERS)
+  {
+    return UNSUPPORTED_OPERATION;
+  }
+
+  pipeline_t pipeline;
+  pipeline.paths = paths;
+  pipeline.countPaths = count;
+  pipeline.options = options;
+  pipeline.countFree = options->countBuffers;
+  pipeline.readyHead = 0;
+  pipeline.countReady = 0;
+  pipeline.isDone = false;
+  for (size_t i = 0; i < options->countBuffers; i++)
+  {
+    pipeline.freeSlots[i] = i;
+    pipeline.slots[i].fd = -1;
+  }
+  pthread_mutex_init(&pipeline.lock, nullptr);
+  pthread_cond_init(&pipeline.isReady, nullptr);
+  pthread_cond_init(&pipeline.isFree, nullptr);
+
+  // Workers beyond one per file would only wait
+  const size_t maxWorkers =
+      count < options->countWorkers ? count : options->countWorkers;
+  pthread_t workers[JSONMAXWORKERS];
+  size_t countWorkers = 0;
+  while (countWorkers < maxWorkers &&
+         pthread_create(&workers[countWorkers], nullptr, RunWorker,
+                        &pipeline) == 0)
+  {
+    countWorkers++;
+  }
+
+  status_json_t status = FUNC_SUCCESS;
+  size_t next = 0;
+  if (countWorkers < maxWorkers)
+  {
+    status = MEMORY_FAILURE;
+    next = count;
+  }
+
+#ifdef JSON_HAS_URING
+  ring_t ring;
+  if (next < count && !options->isBlocking &&
+      OpenRing(&ring, options->countBuffers))
+  {
+    // Reads that were in flight when the ring failed are finished with
+    // blocking reads, once the kernel no longer writes into their buffers.
+    // Slots still holding an open file are the ones left unfinished
+    const bool isFailed = RunRing(&pipeline, &ring, &next) > 0;
+    if (isFailed)
+      DrainRing(&ring, &pipeline);
+    CloseRing(&ring);
+    for (size_t i = 0; isFailed && i < options->countBuffers; i++)
+    {
+      if (pipeline.slots[i].fd >= 0)
+      {
+        ReadSlot(&pipeline, i);
+        PublishSlot(&pipeline, i);
+      }
+    }
+  }
+#endif
+  RunBlocking(&pipeline, next);
+
+  pthread_mutex_lock(&pipeline.lock);
+  pipeline.isDone = true;
+  pthread_cond_broadcast(&pipeline.isReady);
+  pthread_mutex_unlock(&pipeline.lock);
+  for (size_t t = 0; t < countWorkers; t++)
+    pthread_join(workers[t], nullptr);
+
+  pthread_cond_destroy(&pipeline.isFree);
+  pthread_cond_destroy(&pipeline.isReady);
+  pthread_mutex_destroy(&pipeline.lock);
+  return status;
+}
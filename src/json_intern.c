@@ -0,0 +1,92 @@
+#include "json_internal.h"
+
+// Interning: every distinct byte sequence is copied once into the storage of
+// the table and handed out from there afterwards. Keys and enum-like values
+// repeated across records then share one copy, and equal strings have equal
+// pointers. The storage is part of the table and never moves
+
+// Private members
+
+// New strings are refused past three quarters of the slots, which keeps the
+// probe sequences short and guarantees that every probe ends at a free slot
+constexpr size_t MAX_INTERN_COUNT = JSONINTERNSIZE / 4 * 3;
+
+// Shared by every table, since a free slot is marked by a zero length
+static const char EMPTY_STRING[1] = "";
+
+// Public members
+
+void InitJsonIntern(json_intern_t *table)
+{
+  table->count = 0;
+  table->used = 0;
+  table->hits = 0;
+  table->misses = 0;
+  memset(table->entries, 0, sizeof(table->entries));
+}
+
+status_json_t InternJsonString(json_intern_t *table, const char *str,
+                               const size_t length, const char **dest)
+{
+  if (length == 0)
+  {
+    table->hits++;
+    *dest = EMPTY_STRING;
+    return FUNC_SUCCESS;
+  }
+
+  const unsigned long long hash = HashBytes(str, length);
+  size_t slot = hash % JSONINTERNSIZE;
+  intern_entry_json_t *entry;
+  while ((entry = &table->entries[slot])->length != 0)
+  {
+    if (entry->hash == hash && entry->length == length &&
+        memcmp(&table->storage[entry->offset], str, length) == 0)
+    {
+      table->hits++;
+      *dest = &table->storage[entry->offset];
+      return FUNC_SUCCESS;
+    }
+    slot = (slot + 1) % JSONINTERNSIZE;
+  }
+
+  if (table->count >= MAX_INTERN_COUNT ||
+      length >= JSONINTERNBYTES - table->used)
+  {
+    return MEMORY_FAILURE;
+  }
+
+  char *copy = &table->storage[table->used];
+  memcpy(copy, str, length);
+  copy[length] = '\0';
+
+  entry->hash = hash;
+  entry->offset = table->used;
+  entry->length = length;
+  table->used += length + 1;
+  table->count++;
+  table->misses++;
+  *dest = copy;
+  return FUNC_SUCCESS;
+}
+
+status_json_t ConvertJsonToInternedString(json_intern_t *table,
+                                          const string_json_t *src,
+                                          const char **dest)
+{
+  return InternJsonString(table, src->str, src->length, dest);
+}
+
+status_json_t ViewGetInternedString(json_intern_t *table,
+                                    const json_view_t view, const char **dest)
+{
+  const char *str;
+  size_t length;
+  status_json_t status;
+  if ((status = ViewGetString(view, &str, &length)) != FUNC_SUCCESS)
+  {
+    return status;
+  }
+
+  return InternJsonString(table, str, length, dest);
+}
@@ -0,0 +1,271 @@
+#ifndef JSON_INTERNAL_H
+#define JSON_INTERNAL_H
+
+#include "json.h"
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Scanning helpers shared by the translation units of the library. Not part of
+// the public API
+
+// Deepest nesting the scanners keep track of
+constexpr size_t MAX_NESTING_LEVEL = JSONMAXDEPTH;
+
+// Lookup table covering the whole JSON whitespace set (RFC 8259, section 2)
+static const bool WHITESPACE_TABLE[UCHAR_MAX + 1] = {
+    [SPACE] = true,
+    [TAB] = true,
+    [NEWLINE] = true,
+    [CARRIAGE_RETURN] = true,
+};
+
+static inline bool IsWhitespace(const char c)
+{
+  return WHITESPACE_TABLE[(unsigned char)c];
+}
+
+static inline size_t SkipWhitespace(const char *const str, size_t i,
+                                    const size_t length)
+{
+  while (i < length && IsWhitespace(str[i]))
+    i++;
+  return i;
+}
+
+static inline bool IsNumberCharacter(const char c)
+{
+  switch (c)
+  {
+  case MINUS:
+  case PLUS:
+  case PERIOD:
+  case 'e':
+  case 'E':
+    return true;
+  default:
+    return isdigit((unsigned char)c);
+  }
+}
+
+// Advances the state of a string literal by one character. Returns false once
+// the closing double quotes have been consumed
+static inline bool ReadStringCharacter(const char c, bool *isEscaped)
+{
+  if (*isEscaped)
+  {
+    *isEscaped = false;
+    return true;
+  }
+
+  if (c == BACKSLASH)
+  {
+    *isEscaped = true;
+    return true;
+  }
+
+  return c != DOUBLE_QUOTES;
+}
+
+// Bytes that end a run of plain characters inside a string
+static const bool STRING_STOP_TABLE[UCHAR_MAX + 1] = {
+    [DOUBLE_QUOTES] = true,
+    [BACKSLASH] = true,
+};
+
+// Returns the index one past the string starting at str[i], or i if the
+// string is not terminated
+static inline size_t SkipString(const char *str, const size_t i,
+                                const size_t length)
+{
+  size_t n = i + 1;
+  while (n < length)
+  {
+    while (n < length && !STRING_STOP_TABLE[(unsigned char)str[n]])
+      n++;
+    if (n >= length)
+      break;
+    if (str[n] == DOUBLE_QUOTES)
+      return n + 1;
+    n += 2; // Escaped character
+  }
+  return i;
+}
+
+// Bytes that change the nesting level or start a string inside a container
+static const bool CONTAINER_STOP_TABLE[UCHAR_MAX + 1] = {
+    [DOUBLE_QUOTES] = true, [CURLY_OPEN] = true,   [SQUARE_OPEN] = true,
+    [CURLY_CLOSE] = true,   [SQUARE_CLOSE] = true,
+};
+
+// Returns the index one past the value starting at str[i], or i if the value
+// is not terminated
+static inline size_t SkipValue(const char *str, const size_t i,
+                               const size_t length)
+{
+  size_t nestingLevel = 0;
+  size_t n = i;
+
+  switch (str[i])
+  {
+  case DOUBLE_QUOTES:
+    return SkipString(str, i, length);
+
+  case CURLY_OPEN:
+  case SQUARE_OPEN:
+    while (n < length)
+    {
+      while (n < length && !CONTAINER_STOP_TABLE[(unsigned char)str[n]])
+        n++;
+      if (n >= length)
+        break;
+
+      switch (str[n])
+      {
+      case DOUBLE_QUOTES:
+        const size_t end = SkipString(str, n, length);
+        if (end == n)
+          return i;
+        n = end;
+        continue;
+      case CURLY_OPEN:
+      case SQUARE_OPEN:
+        nestingLevel++;
+        break;
+      default:
+        if (--nestingLevel == 0)
+          return n + 1;
+        break;
+      }
+      n++;
+    }
+    return i;
+
+  default:
+    while (n < length && !IsWhitespace(str[n]) && str[n] != COMMA &&
+           str[n] != CURLY_CLOSE && str[n] != SQUARE_CLOSE)
+    {
+      n++;
+    }
+    return n;
+  }
+}
+
+static inline size_t SkipDigits(const char *str, size_t i, const size_t length)
+{
+  while (i < length && isdigit((unsigned char)str[i]))
+    i++;
+  return i;
+}
+
+// Returns the index one past the number literal starting at str[i] following
+// the grammar of RFC 8259, section 6, or i if there is no valid literal
+static inline size_t ScanNumber(const char *str, const size_t i,
+                                const size_t length, bool *isInteger)
+{
+  size_t n = i;
+  *isInteger = true;
+
+  if (n < length && str[n] == MINUS)
+    n++;
+  if (n >= length || !isdigit((unsigned char)str[n]))
+    return i;
+  n = str[n] == '0' ? n + 1 : SkipDigits(str, n, length);
+
+  if (n < length && str[n] == PERIOD)
+  {
+    const size_t fraction = n + 1;
+    if ((n = SkipDigits(str, fraction, length)) == fraction)
+      return i;
+    *isInteger = false;
+  }
+
+  if (n < length && (str[n] == 'e' || str[n] == 'E'))
+  {
+    n++;
+    if (n < length && (str[n] == PLUS || str[n] == MINUS))
+      n++;
+    const size_t exponent = n;
+    if ((n = SkipDigits(str, exponent, length)) == exponent)
+      return i;
+    *isInteger = false;
+  }
+
+  return n;
+}
+
+// 64-bit FNV-1a
+static inline unsigned long long HashBytes(const char *bytes,
+                                           const size_t length)
+{
+  unsigned long long hash = 0xcbf29ce484222325ULL;
+  for (size_t i = 0; i < length; i++)
+  {
+    hash ^= (unsigned char)bytes[i];
+    hash *= 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+// Moves a cursor past the value it handed out last, whose length is known, so
+// that the next member does not scan it again
+static inline void SkipPending(json_cursor_t *cursor, const json_view_t value,
+                               const size_t length)
+{
+  cursor->position = value.str - cursor->str + length;
+  cursor->isPending = false;
+}
+
+// Text output of the functions that write a new document into a buffer of the
+// caller
+typedef struct
+{
+  char *dest;
+  size_t capacity;
+  size_t length;
+} text_writer_t;
+
+// Appends bytes to the output. Without a destination only the length is
+// counted
+static inline void EmitText(text_writer_t *writer, const char *bytes,
+                            const size_t size)
+{
+  if (writer->dest != nullptr && size <= writer->capacity &&
+      writer->length <= writer->capacity - size)
+  {
+    memcpy(&writer->dest[writer->length], bytes, size);
+  }
+  writer->length += size;
+}
+
+// Appends a key as written, with its double quotes, preceded by a comma
+// unless it is the first member of its object
+static inline void EmitTextKey(text_writer_t *writer, const json_view_t key,
+                               size_t *count)
+{
+  if ((*count)++ > 0)
+    EmitText(writer, ",", 1);
+  EmitText(writer, key.str, key.length);
+  EmitText(writer, ":", 1);
+}
+
+// Terminates the output and reports its length
+static inline status_json_t FinishText(text_writer_t *writer, size_t *written)
+{
+  EmitText(writer, "", 1);
+  *written = writer->length - 1;
+  return writer->dest != nullptr && writer->length > writer->capacity
+             ? MEMORY_FAILURE
+             : FUNC_SUCCESS;
+}
+
+// Parses a number literal into a whole number within [min, max], truncating
+// fractions. Defined in json_number.c
+status_json_t ParseInteger(const char *str, size_t length, long long min,
+                           long long max, long long *dest);
+
+// Makes room for count items in an array filled by a conversion. Defined in
+// json.c
+status_json_t ReserveJsonArray(array_json_t *array, size_t count);
+
+#endif
@@ -0,0 +1,310 @@
+#include "json_internal.h"
+#include <float.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// Number literals are parsed straight from the document. Most values take the
+// fast path below, which is exact; The rest are rewritten as a plain digit
+// string and exponent, which strtod rounds correctly whatever the locale
+
+// Private members
+
+// Digits that always fit into an unsigned long long
+constexpr size_t MAX_MANTISSA_DIGITS = 19;
+
+// Digits after which more digits can no longer change the rounding of a
+// double; Anything beyond is folded into one sticky digit
+constexpr size_t MAX_SIGNIFICANT_DIGITS = 768;
+
+// Decimal exponents past this are zero or infinite whatever the digits
+constexpr long long MAX_EXPONENT = 100000;
+
+// 2^53, the largest mantissa a double holds exactly
+constexpr unsigned long long MAX_EXACT_MANTISSA = 1ULL << 53;
+
+static const double POWERS_OF_TEN[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+constexpr long long MAX_EXACT_POWER =
+    sizeof(POWERS_OF_TEN) / sizeof(POWERS_OF_TEN[0]) - 1;
+
+typedef struct
+{
+  bool isNegative;
+  bool isInteger;
+  // The first MAX_MANTISSA_DIGITS significant digits
+  unsigned long long mantissa;
+  // Power of ten to scale the mantissa by
+  long long exponent;
+  // Significant digits were dropped from the mantissa
+  bool isTruncated;
+} number_parts_t;
+
+// Splits a literal into its parts. The whole span must be one literal
+static status_json_t SplitNumber(const char *str, const size_t length,
+                                 number_parts_t *parts)
+{
+  if (length == 0 || ScanNumber(str, 0, length, &parts->isInteger) != length)
+    return INVALID_NUMBER;
+
+  size_t i = 0;
+  parts->isNegative = str[0] == MINUS;
+  parts->mantissa = 0;
+  parts->exponent = 0;
+  parts->isTruncated = false;
+  if (parts->isNegative)
+    i++;
+
+  size_t digits = 0;
+  bool isFraction = false;
+  for (; i < length && str[i] != 'e' && str[i] != 'E'; i++)
+  {
+    if (str[i] == PERIOD)
+    {
+      isFraction = true;
+      continue;
+    }
+
+    const unsigned digit = str[i] - '0';
+    if (digits == 0 && digit == 0)
+    {
+      parts->exponent -= isFraction;
+    }
+    else if (digits < MAX_MANTISSA_DIGITS)
+    {
+      parts->mantissa = parts->mantissa * 10 + digit;
+      parts->exponent -= isFraction;
+      digits++;
+    }
+    else
+    {
+      parts->isTruncated |= digit != 0;
+      parts->exponent += !isFraction;
+    }
+  }
+
+  if (i < length)
+  {
+    i++;
+    const bool isExponentNegative = str[i] == MINUS;
+    if (str[i] == MINUS || str[i] == PLUS)
+      i++;
+
+    long long exponent = 0;
+    for (; i < length; i++)
+    {
+      if (exponent < MAX_EXPONENT)
+        exponent = exponent * 10 + (str[i] - '0');
+    }
+    parts->exponent += isExponentNegative ? -exponent : exponent;
+  }
+
+  return FUNC_SUCCESS;
+}
+
+// Clinger's fast path: both the mantissa and the power of ten are exact
+// doubles, so a single multiplication or division rounds correctly
+static bool TryFastPath(const number_parts_t *parts, double *dest)
+{
+#if FLT_EVAL_METHOD == 0
+  if (parts->isTruncated || parts->mantissa > MAX_EXACT_MANTISSA)
+    return false;
+
+  unsigned long long mantissa = parts->mantissa;
+  long long exponent = parts->exponent;
+
+  // 123e25 is 123000e22, which is still exact
+  while (exponent > MAX_EXACT_POWER && mantissa <= MAX_EXACT_MANTISSA / 10)
+  {
+    mantissa *= 10;
+    exponent--;
+  }
+  if (exponent > MAX_EXACT_POWER || exponent < -MAX_EXACT_POWER)
+    return false;
+
+  const double value = (double)mantissa;
+  *dest = exponent < 0 ? value / POWERS_OF_TEN[-exponent]
+                       : value * POWERS_OF_TEN[exponent];
+  if (parts->isNegative)
+    *dest = -*dest;
+  return true;
+#else
+  (void)parts;
+  (void)dest;
+  return false;
+#endif
+}
+
+// Rewrites the literal as its significant digits and an exponent, leaving
+// nothing for the locale to interpret, and lets strtod round it
+static double ParseSlowPath(const char *str, const size_t length)
+{
+  char temp[MAX_SIGNIFICANT_DIGITS + 32];
+  size_t n = 0;
+  size_t i = 0;
+  if (str[0] == MINUS)
+  {
+    temp[n++] = MINUS;
+    i++;
+  }
+
+  // Power of ten of the digit after the last one kept
+  long long exponent = 0;
+  size_t digits = 0;
+  bool isFraction = false, isSticky = false;
+  for (; i < length && str[i] != 'e' && str[i] != 'E'; i++)
+  {
+    if (str[i] == PERIOD)
+    {
+      isFraction = true;
+      continue;
+    }
+
+    if (digits == 0 && str[i] == '0')
+    {
+      exponent -= isFraction;
+    }
+    else if (digits < MAX_SIGNIFICANT_DIGITS)
+    {
+      temp[n++] = str[i];
+      exponent -= isFraction;
+      digits++;
+    }
+    else
+    {
+      isSticky |= str[i] != '0';
+      exponent += !isFraction;
+    }
+  }
+
+  if (digits == 0)
+    temp[n++] = '0';
+
+  // A nonzero digit past the last one kept breaks exact halfway ties
+  if (isSticky)
+  {
+    temp[n++] = '1';
+    exponent--;
+  }
+
+  if (i < length)
+  {
+    i++;
+    const bool isExponentNegative = str[i] == MINUS;
+    if (str[i] == MINUS || str[i] == PLUS)
+      i++;
+
+    long long literalExponent = 0;
+    for (; i < length; i++)
+    {
+      if (literalExponent < MAX_EXPONENT)
+        literalExponent = literalExponent * 10 + (str[i] - '0');
+    }
+    exponent += isExponentNegative ? -literalExponent : literalExponent;
+  }
+
+  snprintf(&temp[n], sizeof(temp) - n, "e%lld", exponent);
+  return strtod(temp, nullptr);
+}
+
+static status_json_t ParseDouble(const char *str, const size_t length,
+                                 double *dest)
+{
+  number_parts_t parts;
+  status_json_t status;
+  if ((status = SplitNumber(str, length, &parts)) != FUNC_SUCCESS)
+    return status;
+
+  if (parts.mantissa == 0 && !parts.isTruncated)
+  {
+    *dest = parts.isNegative ? -0.0 : 0.0;
+    return FUNC_SUCCESS;
+  }
+
+  if (!TryFastPath(&parts, dest))
+    *dest = ParseSlowPath(str, length);
+
+  return isinf(*dest) ? NUMBER_OUT_OF_RANGE : FUNC_SUCCESS;
+}
+
+// Public members
+
+// Integers are read digit by digit so that every value of a long long is
+// exact. Fractions and exponents go through the double and are truncated
+status_json_t ParseInteger(const char *str, const size_t length,
+                                  const long long min, const long long max,
+                                  long long *dest)
+{
+  number_parts_t parts;
+  status_json_t status;
+  if ((status = SplitNumber(str, length, &parts)) != FUNC_SUCCESS)
+    return status;
+
+  if (!parts.isInteger)
+  {
+    double value;
+    if ((status = ParseDouble(str, length, &value)) != FUNC_SUCCESS)
+      return status;
+
+    // Casting truncates toward zero. min is a power of two and exact, max and
+    // min - 1 are not always
+    if (!((value >= (double)min || value > (double)min - 1.0) &&
+          value < -(double)min))
+    {
+      return NUMBER_OUT_OF_RANGE;
+    }
+    *dest = (long long)value;
+    return FUNC_SUCCESS;
+  }
+
+  const unsigned long long limit =
+      parts.isNegative ? (unsigned long long)-(min + 1) + 1
+                       : (unsigned long long)max;
+  unsigned long long magnitude = 0;
+  for (size_t i = parts.isNegative; i < length; i++)
+  {
+    const unsigned digit = str[i] - '0';
+    if (magnitude > (limit - digit) / 10)
+      return NUMBER_OUT_OF_RANGE;
+    magnitude = magnitude * 10 + digit;
+  }
+
+  *dest = parts.isNegative ? (long long)(0 - magnitude) : (long long)magnitude;
+  return FUNC_SUCCESS;
+}
+
+status_json_t ParseJsonDouble(const char *str, const size_t length,
+                              double *dest)
+{
+  return ParseDouble(str, length, dest);
+}
+
+status_json_t ParseJsonLong(const char *str, const size_t length, long *dest)
+{
+  long long value;
+  status_json_t status;
+  if ((status = ParseInteger(str, length, LONG_MIN, LONG_MAX, &value)) !=
+      FUNC_SUCCESS)
+  {
+    return status;
+  }
+
+  *dest = (long)value;
+  return FUNC_SUCCESS;
+}
+
+status_json_t ParseJsonInt(const char *str, const size_t length, int *dest)
+{
+  long long value;
+  status_json_t status;
+  if ((status = ParseInteger(str, length, INT_MIN, INT_MAX, &value)) !=
+      FUNC_SUCCESS)
+  {
+    return status;
+  }
+
+  *dest = (int)value;
+  return FUNC_SUCCESS;
+}
@@ -0,0 +1,380 @@
+#include "json_internal.h"
+
+// Diffing and merging of documents held as views, following JSON Merge Patch
+// (RFC 7386). Both documents are walked member by member and nothing is
+// decoded: keys are compared as written, values that are byte for byte the
+// same are skipped with one memcmp, and values that are copied to the output
+// are copied as written. Only objects are merged; Any other value replaces
+
+// Private members
+
+// Emits a value as written in the document
+static status_json_t EmitValue(text_writer_t *writer, const json_view_t value)
+{
+  const size_t length = SkipValue(value.str, 0, value.length);
+  if (length == 0)
+    return UNSUPPORTED_OPERATION;
+
+  EmitText(writer, value.str, length);
+  return FUNC_SUCCESS;
+}
+
+static bool IsSameBytes(const json_view_t a, const size_t aLength,
+                        const json_view_t b, const size_t bLength)
+{
+  return aLength == bLength && memcmp(a.str, b.str, aLength) == 0;
+}
+
+// Compares a value with another one whose end is already known, which saves
+// scanning it. A number or literal could go on past the same bytes, so the
+// byte that follows must end the value
+static bool IsSameValue(const json_view_t value, const json_view_t other,
+                        const size_t otherLength)
+{
+  if (otherLength > value.length ||
+      memcmp(value.str, other.str, otherLength) != 0)
+  {
+    return false;
+  }
+
+  const char next = otherLength < value.length ? value.str[otherLength] : ' ';
+  return IsWhitespace(next) || next == COMMA || next == CURLY_CLOSE ||
+         next == SQUARE_CLOSE;
+}
+
+// Finds the member of object whose key is written exactly like key, and
+// stores its position among the members in index
+static status_json_t FindMember(const json_view_t object, const json_view_t key,
+                                json_view_t *dest, size_t *index)
+{
+  json_cursor_t cursor;
+  json_view_t candidate;
+  status_json_t status = ViewIterate(object, &cursor);
+  for (size_t i = 0; status == FUNC_SUCCESS; i++)
+  {
+    if ((status = ViewNextField(&cursor, &candidate, dest)) == FUNC_SUCCESS &&
+        IsSameBytes(candidate, candidate.length, key, key.length))
+    {
+      *index = i;
+      return FUNC_SUCCESS;
+    }
+  }
+  return status;
+}
+
+// Reads the next member, or marks the cursor as done after the last one
+static status_json_t NextMember(json_cursor_t *cursor, bool *isDone,
+                                json_view_t *key, json_view_t *value)
+{
+  if (*isDone)
+    return FUNC_SUCCESS;
+
+  const status_json_t status = ViewNextField(cursor, key, value);
+  if (status == UNDEFINED_KEY)
+  {
+    *isDone = true;
+    return FUNC_SUCCESS;
+  }
+  return status;
+}
+
+static status_json_t DiffObjects(const json_view_t *original,
+                                 json_view_t modified, text_writer_t *writer,
+                                 size_t depth, size_t *count);
+
+// Emits the change of one member, if any. before is nullptr for an added
+// member
+static status_json_t DiffMember(const json_view_t key,
+                                const json_view_t *before,
+                                const json_view_t after,
+                                text_writer_t *writer, const size_t depth,
+                                size_t *count)
+{
+  if (before != nullptr &&
+      IsSameValue(after, *before, SkipValue(before->str, 0, before->length)))
+  {
+    return FUNC_SUCCESS;
+  }
+
+  const size_t afterLength = SkipValue(after.str, 0, after.length);
+  if (afterLength == 0)
+    return UNSUPPORTED_OPERATION;
+
+  // A null in a merge patch removes the member instead of setting it
+  if (after.type == JNULL)
+    return UNSUPPORTED_OPERATION;
+
+  const size_t mark = writer->length;
+  const size_t countBefore = *count;
+  EmitTextKey(writer, key, count);
+  if (after.type != JOBJECT)
+  {
+    EmitText(writer, after.str, afterLength);
+    return FUNC_SUCCESS;
+  }
+
+  // Objects are patched member by member, even new ones, so that the nulls
+  // they may hold are caught above
+  const bool isMerged = before != nullptr && before->type == JOBJECT;
+  size_t nested = 0;
+  status_json_t status;
+  EmitText(writer, "{", 1);
+  if ((status = DiffObjects(isMerged ? before : nullptr, after, writer,
+                            depth + 1, &nested)) != FUNC_SUCCESS)
+  {
+    return status;
+  }
+  EmitText(writer, "}", 1);
+
+  // Objects that only differ in whitespace need no patch
+  if (isMerged && nested == 0)
+  {
+    writer->length = mark;
+    *count = countBefore;
+  }
+  return FUNC_SUCCESS;
+}
+
+// Emits the members that turn original into modified. Both are walked in
+// lockstep, and members are only looked up when the keys stop lining up. A
+// nullptr original stands for an empty object
+static status_json_t DiffObjects(const json_view_t *original,
+                                 const json_view_t modified,
+                                 text_writer_t *writer, const size_t depth,
+                                 size_t *count)
+{
+  if (depth >= MAX_NESTING_LEVEL)
+    return UNSUPPORTED_OPERATION;
+
+  json_cursor_t originalCursor, modifiedCursor;
+  bool isOriginalDone = original == nullptr, isModifiedDone = false;
+  status_json_t status;
+  if ((!isOriginalDone &&
+       (status = ViewIterate(*original, &originalCursor)) != FUNC_SUCCESS) ||
+      (status = ViewIterate(modified, &modifiedCursor)) != FUNC_SUCCESS)
+  {
+    return status;
+  }
+
+  json_view_t originalKey, originalValue, modifiedKey, modifiedValue;
+  json_view_t counterpart;
+  size_t index;
+  for (;;)
+  {
+    if ((status = NextMember(&originalCursor, &isOriginalDone, &originalKey,
+                             &originalValue)) != FUNC_SUCCESS ||
+        (status = NextMember(&modifiedCursor, &isModifiedDone, &modifiedKey,
+                             &modifiedValue)) != FUNC_SUCCESS)
+    {
+      return status;
+    }
+    if (isOriginalDone && isModifiedDone)
+      return FUNC_SUCCESS;
+
+    if (!isOriginalDone && !isModifiedDone &&
+        IsSameBytes(originalKey, originalKey.length, modifiedKey,
+                    modifiedKey.length))
+    {
+      // Unchanged members, the common case, are scanned once
+      const size_t length =
+          SkipValue(originalValue.str, 0, originalValue.length);
+      if (length == 0)
+        return UNSUPPORTED_OPERATION;
+      if (IsSameValue(modifiedValue, originalValue, length))
+      {
+        SkipPending(&originalCursor, originalValue, length);
+        SkipPending(&modifiedCursor, modifiedValue, length);
+        continue;
+      }
+
+      if ((status = DiffMember(modifiedKey, &originalValue, modifiedValue,
+                               writer, depth, count)) != FUNC_SUCCESS)
+      {
+        return status;
+      }
+      continue;
+    }
+
+    // The modified member is handled here, wherever it was in the original
+    if (!isModifiedDone)
+    {
+      status = original != nullptr
+                   ? FindMember(*original, modifiedKey, &counterpart, &index)
+                   : UNDEFINED_KEY;
+      if ((status != FUNC_SUCCESS && status != UNDEFINED_KEY) ||
+          (status = DiffMember(modifiedKey,
+                               status == FUNC_SUCCESS ? &counterpart : nullptr,
+                               modifiedValue, writer, depth, count)) !=
+              FUNC_SUCCESS)
+      {
+        return status;
+      }
+    }
+
+    // The original member only needs a patch if it was removed
+    if (!isOriginalDone)
+    {
+      status = FindMember(modified, originalKey, &counterpart, &index);
+      if (status == UNDEFINED_KEY)
+      {
+        EmitTextKey(writer, originalKey, count);
+        EmitText(writer, "null", 4);
+      }
+      else if (status != FUNC_SUCCESS)
+      {
+        return status;
+      }
+    }
+  }
+}
+
+static status_json_t MergeObjects(const json_view_t *target,
+                                  json_view_t patch, text_writer_t *writer,
+                                  size_t depth);
+
+static status_json_t MergeMember(const json_view_t key,
+                                 const json_view_t *before,
+                                 const json_view_t patch,
+                                 text_writer_t *writer, const size_t depth,
+                                 size_t *count)
+{
+  if (patch.type == JNULL)
+    return FUNC_SUCCESS;
+
+  EmitTextKey(writer, key, count);
+  if (patch.type != JOBJECT)
+    return EmitValue(writer, patch);
+
+  return MergeObjects(before != nullptr && before->type == JOBJECT ? before
+                                                                   : nullptr,
+                      patch, writer, depth + 1);
+}
+
+// Emits target with patch merged into it, target members first and in their
+// order, then the new ones. A nullptr target stands for an empty object
+static status_json_t MergeObjects(const json_view_t *target,
+                                  const json_view_t patch,
+                                  text_writer_t *writer, const size_t depth)
+{
+  if (depth >= MAX_NESTING_LEVEL)
+    return UNSUPPORTED_OPERATION;
+
+  // Patch members already merged while walking the target, for the first
+  // ones; The rest are looked up again
+  unsigned long long merged = 0;
+  const size_t countTracked = sizeof(merged) * CHAR_BIT;
+
+  json_cursor_t cursor;
+  json_view_t key, value, counterpart;
+  size_t count = 0, index;
+  status_json_t status;
+  EmitText(writer, "{", 1);
+  if (target != nullptr)
+  {
+    if ((status = ViewIterate(*target, &cursor)) != FUNC_SUCCESS)
+      return status;
+    while ((status = ViewNextField(&cursor, &key, &value)) == FUNC_SUCCESS)
+    {
+      status = FindMember(patch, key, &counterpart, &index);
+      if (status == FUNC_SUCCESS)
+      {
+        if (index < countTracked)
+          merged |= 1ull << index;
+        if ((status = MergeMember(key, &value, counterpart, writer, depth,
+                                  &count)) != FUNC_SUCCESS)
+        {
+          return status;
+        }
+        continue;
+      }
+      if (status != UNDEFINED_KEY)
+        return status;
+
+      // Untouched members are copied as written, and scanned once
+      const size_t length = SkipValue(value.str, 0, value.length);
+      if (length == 0)
+        return UNSUPPORTED_OPERATION;
+      EmitTextKey(writer, key, &count);
+      EmitText(writer, value.str, length);
+      SkipPending(&cursor, value, length);
+    }
+    if (status != UNDEFINED_KEY)
+      return status;
+  }
+
+  if ((status = ViewIterate(patch, &cursor)) != FUNC_SUCCESS)
+    return status;
+  for (size_t i = 0;
+       (status = ViewNextField(&cursor, &key, &value)) == FUNC_SUCCESS; i++)
+  {
+    if (target != nullptr)
+    {
+      if (i < countTracked)
+        status = merged >> i & 1 ? FUNC_SUCCESS : UNDEFINED_KEY;
+      else
+        status = FindMember(*target, key, &counterpart, &index);
+      if (status == FUNC_SUCCESS)
+        continue;
+      if (status != UNDEFINED_KEY)
+        return status;
+    }
+
+    if ((status = MergeMember(key, nullptr, value, writer, depth, &count)) !=
+        FUNC_SUCCESS)
+    {
+      return status;
+    }
+  }
+  if (status != UNDEFINED_KEY)
+    return status;
+
+  EmitText(writer, "}", 1);
+  return FUNC_SUCCESS;
+}
+
+// Public members
+
+status_json_t DiffJson(const json_view_t original, const json_view_t modified,
+                       char *dest, const size_t capacity, size_t *written)
+{
+  text_writer_t writer = {dest, capacity, 0};
+  status_json_t status;
+  if (modified.type != JOBJECT)
+  {
+    // Anything but an object replaces the whole document
+    if ((status = EmitValue(&writer, modified)) != FUNC_SUCCESS)
+      return status;
+    return FinishText(&writer, written);
+  }
+
+  // Identical documents are told apart from changed ones in one memcmp
+  size_t count = 0;
+  const bool isSame =
+      original.type == JOBJECT &&
+      IsSameBytes(original, original.length, modified, modified.length);
+  EmitText(&writer, "{", 1);
+  if (!isSame &&
+      (status = DiffObjects(original.type == JOBJECT ? &original : nullptr,
+                            modified, &writer, 0, &count)) != FUNC_SUCCESS)
+  {
+    return status;
+  }
+  EmitText(&writer, "}", 1);
+  return FinishText(&writer, written);
+}
+
+status_json_t ApplyJsonMergePatch(const json_view_t target,
+                                  const json_view_t patch, char *dest,
+                                  const size_t capacity, size_t *written)
+{
+  text_writer_t writer = {dest, capacity, 0};
+  status_json_t status =
+      patch.type != JOBJECT
+          ? EmitValue(&writer, patch)
+          : MergeObjects(target.type == JOBJECT ? &target : nullptr, patch,
+                         &writer, 0);
+  if (status != FUNC_SUCCESS)
+    return status;
+
+  return FinishText(&writer, written);
+}
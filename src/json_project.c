@@ -0,0 +1,108 @@
+#include "json_internal.h"
+
+// Projection: an object is walked member by member and each key is matched
+// against the first key of every path. Members a path ends at are copied as
+// written in one memcpy, members a path goes through are walked again with
+// the rest of those paths, and all others are skipped by the cursor without
+// being decoded
+
+// Private members
+
+// Length of the first key of a path
+static size_t GetPathKeyLength(const char *path)
+{
+  const char *period = strchr(path, '.');
+  return period != nullptr ? (size_t)(period - path) : strlen(path);
+}
+
+// Emits the members of object that the paths lead to
+static status_json_t ProjectObject(const json_view_t object,
+                                   const char *const *paths,
+                                   const size_t count, text_writer_t *writer,
+                                   const size_t depth, size_t *countMembers)
+{
+  if (depth >= MAX_NESTING_LEVEL)
+    return UNSUPPORTED_OPERATION;
+
+  json_cursor_t cursor;
+  json_view_t key, value;
+  status_json_t status;
+  if ((status = ViewIterate(object, &cursor)) != FUNC_SUCCESS)
+    return status;
+
+  // Rest of the paths that go through the current member
+  const char *nested[JSONMAXPATHS];
+  while ((status = ViewNextField(&cursor, &key, &value)) == FUNC_SUCCESS)
+  {
+    const char *name = &key.str[1];
+    const size_t nameLength = key.length - 2;
+    size_t countNested = 0;
+    bool isKept = false;
+    for (size_t i = 0; i < count && !isKept; i++)
+    {
+      const size_t keyLength = GetPathKeyLength(paths[i]);
+      if (keyLength != nameLength || memcmp(paths[i], name, nameLength) != 0)
+        continue;
+
+      if (paths[i][keyLength] == '\0')
+        isKept = true;
+      else
+        nested[countNested++] = &paths[i][keyLength + 1];
+    }
+
+    if (isKept)
+    {
+      const size_t length = SkipValue(value.str, 0, value.length);
+      if (length == 0)
+        return UNSUPPORTED_OPERATION;
+      EmitTextKey(writer, key, countMembers);
+      EmitText(writer, value.str, length);
+      SkipPending(&cursor, value, length);
+      continue;
+    }
+    if (countNested == 0 || value.type != JOBJECT)
+      continue;
+
+    const size_t mark = writer->length;
+    const size_t countBefore = *countMembers;
+    size_t countInner = 0;
+    EmitTextKey(writer, key, countMembers);
+    EmitText(writer, "{", 1);
+    if ((status = ProjectObject(value, nested, countNested, writer, depth + 1,
+                                &countInner)) != FUNC_SUCCESS)
+    {
+      return status;
+    }
+    EmitText(writer, "}", 1);
+
+    // Objects none of the paths found anything in are left out
+    if (countInner == 0)
+    {
+      writer->length = mark;
+      *countMembers = countBefore;
+    }
+  }
+  return status == UNDEFINED_KEY ? FUNC_SUCCESS : status;
+}
+
+// Public members
+
+status_json_t ProjectJson(const json_view_t src, const char *const *paths,
+                          const size_t count, char *dest,
+                          const size_t capacity, size_t *written)
+{
+  if (src.type != JOBJECT || count > JSONMAXPATHS)
+    return UNSUPPORTED_OPERATION;
+
+  text_writer_t writer = {dest, capacity, 0};
+  size_t countMembers = 0;
+  status_json_t status;
+  EmitText(&writer, "{", 1);
+  if ((status = ProjectObject(src, paths, count, &writer, 0, &countMembers)) !=
+      FUNC_SUCCESS)
+  {
+    return status;
+  }
+  EmitText(&writer, "}", 1);
+  return FinishText(&writer, written);
+}
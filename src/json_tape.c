@@ -0,0 +1,827 @@
+#define _POSIX_C_SOURCE 200809L
+#include "json_internal.h"
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Binary tape layout, all integers in host byte order:
+//
+// header   "JTP1" | u32 byte order mark | u64 length of the tape
+// object   tag | u32 member count | u64 end offset | (key, value)...
+// array    tag | u32 item count | u64 end offset | value...
+// key      TAPE_KEY | u32 length | unescaped bytes | '\0'
+// string   tag | u32 length | unescaped bytes | '\0'
+// number   tag | f64 value | i64 value | u8 integer flag
+// boolean  tag | u8 value
+// null     tag
+//
+// Tags are the values of type_json_t. Nodes are stored in document order, so
+// a lookup is a single forward walk and a container is skipped by jumping to
+// its end offset. Offsets are relative to the first byte after the header
+
+// Private members
+
+static const char TAPE_MAGIC[4] = {'J', 'T', 'P', '1'};
+constexpr uint32_t TAPE_BYTE_ORDER = 0x01020304;
+constexpr size_t TAPE_HEADER_SIZE = 16;
+constexpr unsigned char TAPE_KEY = 6;
+constexpr size_t CONTAINER_NODE_SIZE = 13;
+constexpr size_t STRING_NODE_OVERHEAD = 6;
+constexpr size_t NUMBER_NODE_SIZE = 18;
+constexpr size_t BOOLEAN_NODE_SIZE = 2;
+constexpr size_t NULL_NODE_SIZE = 1;
+
+typedef struct
+{
+  unsigned char *dest;
+  size_t capacity;
+  size_t length;
+} tape_writer_t;
+
+typedef struct
+{
+  size_t offset;
+  uint32_t count;
+  bool isObject;
+} tape_frame_t;
+
+// Appends bytes to the tape. Without a destination only the length is counted
+static void Emit(tape_writer_t *writer, const void *bytes, const size_t size)
+{
+  if (writer->dest != nullptr && size <= writer->capacity &&
+      writer->length <= writer->capacity - size)
+  {
+    memcpy(&writer->dest[writer->length], bytes, size);
+  }
+  writer->length += size;
+}
+
+static void Patch(tape_writer_t *writer, const size_t offset,
+                  const void *bytes, const size_t size)
+{
+  if (writer->dest != nullptr && size <= writer->capacity &&
+      offset <= writer->capacity - size)
+  {
+    memcpy(&writer->dest[offset], bytes, size);
+  }
+}
+
+static void EmitTag(tape_writer_t *writer, const unsigned char tag)
+{
+  Emit(writer, &tag, sizeof(tag));
+}
+
+static int HexValue(const char c)
+{
+  if (c >= '0' && c <= '9')
+    return c - '0';
+  if (c >= 'a' && c <= 'f')
+    return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F')
+    return c - 'A' + 10;
+  return -1;
+}
+
+static bool ReadHex4(const char *src, const size_t length, const size_t i,
+                     uint32_t *dest)
+{
+  if (length < 4 || i > length - 4)
+    return false;
+
+  *dest = 0;
+  for (size_t n = i; n < i + 4; n++)
+  {
+    const int value = HexValue(src[n]);
+    if (value < 0)
+      return false;
+    *dest = *dest << 4 | (uint32_t)value;
+  }
+  return true;
+}
+
+static void EmitCodePoint(tape_writer_t *writer, const uint32_t codePoint)
+{
+  unsigned char bytes[4];
+  size_t size;
+  if (codePoint < 0x80)
+  {
+    bytes[0] = (unsigned char)codePoint;
+    size = 1;
+  }
+  else if (codePoint < 0x800)
+  {
+    bytes[0] = (unsigned char)(0xC0 | codePoint >> 6);
+    bytes[1] = (unsigned char)(0x80 | (codePoint & 0x3F));
+    size = 2;
+  }
+  else if (codePoint < 0x10000)
+  {
+    bytes[0] = (unsigned char)(0xE0 | codePoint >> 12);
+    bytes[1] = (unsigned char)(0x80 | (codePoint >> 6 & 0x3F));
+    bytes[2] = (unsigned char)(0x80 | (codePoint & 0x3F));
+    size = 3;
+  }
+  else
+  {
+    bytes[0] = (unsigned char)(0xF0 | codePoint >> 18);
+    bytes[1] = (unsigned char)(0x80 | (codePoint >> 12 & 0x3F));
+    bytes[2] = (unsigned char)(0x80 | (codePoint >> 6 & 0x3F));
+    bytes[3] = (unsigned char)(0x80 | (codePoint & 0x3F));
+    size = 4;
+  }
+  Emit(writer, bytes, size);
+}
+
+// Decodes the escape sequence starting at the backslash in src[*i]
+static status_json_t EmitEscape(const char *src, const size_t length,
+                                size_t *i, tape_writer_t *writer)
+{
+  if (*i + 1 >= length)
+    return UNSUPPORTED_OPERATION;
+
+  char c;
+  switch (src[*i + 1])
+  {
+  case DOUBLE_QUOTES:
+  case BACKSLASH:
+  case '/':
+    c = src[*i + 1];
+    break;
+  case 'b':
+    c = '\b';
+    break;
+  case 'f':
+    c = '\f';
+    break;
+  case 'n':
+    c = '\n';
+    break;
+  case 'r':
+    c = '\r';
+    break;
+  case 't':
+    c = '\t';
+    break;
+  case 'u':
+    uint32_t codePoint, low;
+    if (!ReadHex4(src, length, *i + 2, &codePoint))
+    {
+      return UNSUPPORTED_OPERATION;
+    }
+    *i += 6;
+
+    // Characters outside the BMP are escaped as a surrogate pair. The grammar
+    // also allows unpaired surrogates, which are kept as three bytes each the
+    // way WTF-8 encodes them
+    if (codePoint >= 0xD800 && codePoint <= 0xDBFF && *i + 1 < length &&
+        src[*i] == BACKSLASH && src[*i + 1] == 'u' &&
+        ReadHex4(src, length, *i + 2, &low) && low >= 0xDC00 && low <= 0xDFFF)
+    {
+      codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+      *i += 6;
+    }
+
+    EmitCodePoint(writer, codePoint);
+    return FUNC_SUCCESS;
+  default:
+    return UNSUPPORTED_OPERATION;
+  }
+
+  Emit(writer, &c, sizeof(c));
+  *i += 2;
+  return FUNC_SUCCESS;
+}
+
+// Encodes the string literal starting at the double quotes in src[*i]
+static status_json_t EncodeString(const char *src, const size_t length,
+                                  size_t *i, tape_writer_t *writer,
+                                  const unsigned char tag)
+{
+  const size_t nodeOffset = writer->length;
+  const uint32_t placeholder = 0;
+  EmitTag(writer, tag);
+  Emit(writer, &placeholder, sizeof(placeholder));
+  const size_t textOffset = writer->length;
+
+  size_t n = *i + 1;
+  while (n < length && src[n] != DOUBLE_QUOTES)
+  {
+    if ((unsigned char)src[n] < 0x20)
+      return UNSUPPORTED_OPERATION;
+
+    if (src[n] == BACKSLASH)
+    {
+      status_json_t status;
+      if ((status = EmitEscape(src, length, &n, writer)) != FUNC_SUCCESS)
+        return status;
+      continue;
+    }
+
+    // Copy runs of plain characters in one go
+    size_t end = n;
+    while (end < length && src[end] != DOUBLE_QUOTES &&
+           src[end] != BACKSLASH && (unsigned char)src[end] >= 0x20)
+    {
+      end++;
+    }
+    Emit(writer, &src[n], end - n);
+    n = end;
+  }
+
+  if (n >= length || writer->length - textOffset > UINT32_MAX)
+    return UNSUPPORTED_OPERATION;
+
+  const uint32_t textLength = (uint32_t)(writer->length - textOffset);
+  const char terminator = '\0';
+  Emit(writer, &terminator, sizeof(terminator));
+  Patch(writer, nodeOffset + 1, &textLength, sizeof(textLength));
+  *i = n + 1;
+  return FUNC_SUCCESS;
+}
+
+// Encodes the number literal starting at src[*i]
+static status_json_t EncodeNumber(const char *src, const size_t length,
+                                  size_t *i, tape_writer_t *writer)
+{
+  bool isInteger;
+  const size_t end = ScanNumber(src, *i, length, &isInteger);
+  if (end == *i)
+    return UNSUPPORTED_OPERATION;
+
+  // Overflowing literals are kept as +-HUGE_VAL
+  double value;
+  long long parsed = 0;
+  if (ParseJsonDouble(&src[*i], end - *i, &value) == INVALID_NUMBER)
+    return UNSUPPORTED_OPERATION;
+  if (isInteger)
+  {
+    isInteger = ParseInteger(&src[*i], end - *i, LLONG_MIN, LLONG_MAX,
+                             &parsed) == FUNC_SUCCESS;
+  }
+
+  const int64_t integer = parsed;
+  const unsigned char flag = isInteger;
+  EmitTag(writer, JNUMBER);
+  Emit(writer, &value, sizeof(value));
+  Emit(writer, &integer, sizeof(integer));
+  Emit(writer, &flag, sizeof(flag));
+  *i = end;
+  return FUNC_SUCCESS;
+}
+
+static bool MatchLiteral(const char *src, const size_t length, const size_t i,
+                         const char *literal)
+{
+  const size_t size = strlen(literal);
+  return i <= length && length - i >= size &&
+         memcmp(&src[i], literal, size) == 0;
+}
+
+static status_json_t EncodeScalar(const char *src, const size_t length,
+                                  size_t *i, tape_writer_t *writer)
+{
+  if (*i >= length)
+    return UNSUPPORTED_OPERATION;
+
+  switch (src[*i])
+  {
+  case DOUBLE_QUOTES:
+    return EncodeString(src, length, i, writer, JSTRING);
+  case 't':
+  case 'f':
+    const bool value = src[*i] == 't';
+    if (!MatchLiteral(src, length, *i, value ? "true" : "false"))
+      return UNSUPPORTED_OPERATION;
+
+    const unsigned char byte = value;
+    EmitTag(writer, JBOOLEAN);
+    Emit(writer, &byte, sizeof(byte));
+    *i += value ? 4 : 5;
+    return FUNC_SUCCESS;
+  case 'n':
+    if (!MatchLiteral(src, length, *i, "null"))
+      return UNSUPPORTED_OPERATION;
+
+    EmitTag(writer, JNULL);
+    *i += 4;
+    return FUNC_SUCCESS;
+  default:
+    return EncodeNumber(src, length, i, writer);
+  }
+}
+
+// Encodes a member name and moves past the colon that follows it
+static status_json_t EncodeKey(const char *src, const size_t length,
+                               size_t *i, tape_writer_t *writer)
+{
+  status_json_t status;
+  if (*i >= length || src[*i] != DOUBLE_QUOTES)
+    return UNSUPPORTED_OPERATION;
+  if ((status = EncodeString(src, length, i, writer, TAPE_KEY)) !=
+      FUNC_SUCCESS)
+  {
+    return status;
+  }
+
+  *i = SkipWhitespace(src, *i, length);
+  if (*i >= length || src[*i] != COLON)
+    return UNSUPPORTED_OPERATION;
+  *i = SkipWhitespace(src, *i + 1, length);
+  return FUNC_SUCCESS;
+}
+
+static void CloseContainer(tape_writer_t *writer, const tape_frame_t *frame)
+{
+  const uint64_t end = writer->length - TAPE_HEADER_SIZE;
+  Patch(writer, frame->offset + 1, &frame->count, sizeof(frame->count));
+  Patch(writer, frame->offset + 5, &end, sizeof(end));
+}
+
+static uint32_t ReadU32(const unsigned char *bytes)
+{
+  uint32_t value;
+  memcpy(&value, bytes, sizeof(value));
+  return value;
+}
+
+static uint64_t ReadU64(const unsigned char *bytes)
+{
+  uint64_t value;
+  memcpy(&value, bytes, sizeof(value));
+  return value;
+}
+
+// Returns the size of the node at offset, counting only the header of
+// containers, or 0 if it does not fit inside the tape
+static size_t GetNodeSize(const unsigned char *tape, const size_t length,
+                          const size_t offset)
+{
+  if (offset >= length)
+    return 0;
+
+  size_t size;
+  switch (tape[offset])
+  {
+  case JOBJECT:
+  case JARRAY:
+    size = CONTAINER_NODE_SIZE;
+    break;
+  case JSTRING:
+  case TAPE_KEY:
+    if (length - offset < STRING_NODE_OVERHEAD)
+      return 0;
+    size = STRING_NODE_OVERHEAD + ReadU32(&tape[offset + 1]);
+    break;
+  case JNUMBER:
+    size = NUMBER_NODE_SIZE;
+    break;
+  case JBOOLEAN:
+    size = BOOLEAN_NODE_SIZE;
+    break;
+  case JNULL:
+    size = NULL_NODE_SIZE;
+    break;
+  default:
+    return 0;
+  }
+
+  return size <= length - offset ? size : 0;
+}
+
+// Returns the offset one past the last descendant of a container, or 0 if the
+// tape is corrupted
+static size_t GetContainerEnd(const tape_json_t *src)
+{
+  const uint64_t end = ReadU64(&src->tape[src->offset + 5]);
+  return end <= src->length && end >= src->offset + CONTAINER_NODE_SIZE
+             ? (size_t)end
+             : 0;
+}
+
+static status_json_t ReadValue(const unsigned char *tape, const size_t length,
+                               const size_t offset, tape_json_t *dest)
+{
+  if (GetNodeSize(tape, length, offset) == 0 || tape[offset] == TAPE_KEY)
+    return UNSUPPORTED_OPERATION;
+
+  dest->tape = tape;
+  dest->length = length;
+  dest->offset = offset;
+  dest->type = (type_json_t)tape[offset];
+  return FUNC_SUCCESS;
+}
+
+static void ReadNumber(const tape_json_t *src, double *value, int64_t *integer,
+                       bool *isInteger)
+{
+  const unsigned char *node = &src->tape[src->offset];
+  memcpy(value, &node[1], sizeof(*value));
+  memcpy(integer, &node[9], sizeof(*integer));
+  *isInteger = node[17] != 0;
+}
+
+// Converts a number node to a whole number, truncating fractions
+static status_json_t ReadInteger(const tape_json_t *src, const int64_t min,
+                                 const int64_t max, int64_t *dest)
+{
+  double value;
+  bool isInteger;
+  if (src->type != JNUMBER)
+    return UNSUPPORTED_OPERATION;
+
+  ReadNumber(src, &value, dest, &isInteger);
+  if (!isInteger)
+  {
+    // min is a power of two and exact, max and min - 1 are not always
+    if (!((value >= (double)min || value > (double)min - 1.0) &&
+          value < -(double)min))
+    {
+      return NUMBER_OUT_OF_RANGE;
+    }
+    *dest = (int64_t)value;
+  }
+  return *dest >= min && *dest <= max ? FUNC_SUCCESS : NUMBER_OUT_OF_RANGE;
+}
+
+static status_json_t ConvertTapeArray(const tape_json_t *src,
+                                      const native_json_type_t type,
+                                      array_json_t *dest)
+{
+  if (src->type != JARRAY)
+    return UNSUPPORTED_OPERATION;
+
+  const size_t end = GetContainerEnd(src);
+  if (end == 0)
+    return UNSUPPORTED_OPERATION;
+
+  int count = 0;
+  for (size_t offset = src->offset + CONTAINER_NODE_SIZE; offset < end;
+       offset += NUMBER_NODE_SIZE)
+  {
+    tape_json_t item;
+    status_json_t status;
+    if ((status = ReadValue(src->tape, end, offset, &item)) != FUNC_SUCCESS)
+      return status;
+    if (item.type != JNUMBER)
+      return UNSUPPORTED_OPERATION;
+    if ((status = ReserveJsonArray(dest, count + 1)) != FUNC_SUCCESS)
+      return status;
+
+    double value;
+    int64_t integer;
+    bool isInteger;
+    switch (type)
+    {
+    case JSON_DOUBLE_ARR:
+      ReadNumber(&item, &value, &integer, &isInteger);
+      dest->data.d[count] = value;
+      break;
+    case JSON_LONG_ARR:
+      if ((status = ReadInteger(&item, LONG_MIN, LONG_MAX, &integer)) !=
+          FUNC_SUCCESS)
+      {
+        return status;
+      }
+      dest->data.l[count] = (long)integer;
+      break;
+    default:
+      if ((status = ReadInteger(&item, INT_MIN, INT_MAX, &integer)) !=
+          FUNC_SUCCESS)
+      {
+        return status;
+      }
+      dest->data.i[count] = (int)integer;
+      break;
+    }
+    count++;
+  }
+
+  dest->length = count;
+  return FUNC_SUCCESS;
+}
+
+// Public members
+
+status_json_t ConvertJsonToTape(const char *src, const size_t length,
+                                void *dest, const size_t capacity,
+                                size_t *written)
+{
+  tape_writer_t writer = {dest, capacity, 0};
+  tape_frame_t frames[MAX_NESTING_LEVEL];
+  size_t depth = 0;
+  status_json_t status;
+
+  const unsigned char header[TAPE_HEADER_SIZE] = {0};
+  Emit(&writer, header, sizeof(header));
+
+  size_t i = SkipWhitespace(src, 0, length);
+  while (true)
+  {
+    // A value is expected at src[i]
+    if (i < length && (src[i] == CURLY_OPEN || src[i] == SQUARE_OPEN))
+    {
+      if (depth == MAX_NESTING_LEVEL)
+        return UNSUPPORTED_OPERATION;
+
+      tape_frame_t *frame = &frames[depth++];
+      frame->offset = writer.length;
+      frame->count = 0;
+      frame->isObject = src[i] == CURLY_OPEN;
+
+      const unsigned char placeholder[CONTAINER_NODE_SIZE - 1] = {0};
+      EmitTag(&writer, frame->isObject ? JOBJECT : JARRAY);
+      Emit(&writer, placeholder, sizeof(placeholder));
+
+      i = SkipWhitespace(src, i + 1, length);
+      if (i < length &&
+          src[i] == (frame->isObject ? CURLY_CLOSE : SQUARE_CLOSE))
+      {
+        CloseContainer(&writer, frame);
+        depth--;
+        i++;
+      }
+      else
+      {
+        if (frame->isObject &&
+            (status = EncodeKey(src, length, &i, &writer)) != FUNC_SUCCESS)
+        {
+          return status;
+        }
+        continue;
+      }
+    }
+    else if ((status = EncodeScalar(src, length, &i, &writer)) !=
+             FUNC_SUCCESS)
+    {
+      return status;
+    }
+
+    // A value has been completed; close every container that ends here
+    i = SkipWhitespace(src, i, length);
+    while (depth > 0)
+    {
+      tape_frame_t *frame = &frames[depth - 1];
+      if (frame->count == UINT32_MAX || i >= length)
+        return UNSUPPORTED_OPERATION;
+      frame->count++;
+
+      if (src[i] == COMMA)
+      {
+        i = SkipWhitespace(src, i + 1, length);
+        if (frame->isObject &&
+            (status = EncodeKey(src, length, &i, &writer)) != FUNC_SUCCESS)
+        {
+          return status;
+        }
+        break;
+      }
+
+      if (src[i] != (frame->isObject ? CURLY_CLOSE : SQUARE_CLOSE))
+        return UNSUPPORTED_OPERATION;
+
+      CloseContainer(&writer, frame);
+      depth--;
+      i = SkipWhitespace(src, i + 1, length);
+    }
+
+    if (depth == 0)
+      break;
+  }
+
+  if (i != length)
+    return UNSUPPORTED_OPERATION;
+
+  const uint32_t byteOrder = TAPE_BYTE_ORDER;
+  const uint64_t tapeLength = writer.length - TAPE_HEADER_SIZE;
+  Patch(&writer, 0, TAPE_MAGIC, sizeof(TAPE_MAGIC));
+  Patch(&writer, 4, &byteOrder, sizeof(byteOrder));
+  Patch(&writer, 8, &tapeLength, sizeof(tapeLength));
+
+  *written = writer.length;
+  return dest != nullptr && writer.length > capacity ? MEMORY_FAILURE
+                                                     : FUNC_SUCCESS;
+}
+
+status_json_t SaveJsonTape(const void *tape, const size_t length,
+                           const char *path)
+{
+  FILE *file = fopen(path, "wb");
+  if (file == nullptr)
+    return MEMORY_FAILURE;
+
+  const bool isWritten = fwrite(tape, 1, length, file) == length;
+  if (fclose(file) != 0 || !isWritten)
+    return MEMORY_FAILURE;
+  return FUNC_SUCCESS;
+}
+
+status_json_t OpenJsonTape(const void *data, const size_t length,
+                           tape_json_t *root)
+{
+  const unsigned char *bytes = data;
+  if (length <= TAPE_HEADER_SIZE ||
+      memcmp(bytes, TAPE_MAGIC, sizeof(TAPE_MAGIC)) != 0 ||
+      ReadU32(&bytes[4]) != TAPE_BYTE_ORDER ||
+      ReadU64(&bytes[8]) != length - TAPE_HEADER_SIZE)
+  {
+    return UNSUPPORTED_OPERATION;
+  }
+
+  return ReadValue(&bytes[TAPE_HEADER_SIZE], length - TAPE_HEADER_SIZE, 0,
+                   root);
+}
+
+status_json_t LoadJsonTape(const char *path, tape_file_json_t *file,
+                           tape_json_t *root)
+{
+  const int descriptor = open(path, O_RDONLY);
+  if (descriptor < 0)
+    return MEMORY_FAILURE;
+
+  struct stat info;
+  if (fstat(descriptor, &info) != 0 || info.st_size <= 0)
+  {
+    close(descriptor);
+    return MEMORY_FAILURE;
+  }
+
+  // Pages are only read from disk once a lookup touches them
+  const size_t size = (size_t)info.st_size;
+  void *mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+  close(descriptor);
+  if (mapping == MAP_FAILED)
+    return MEMORY_FAILURE;
+
+  status_json_t status;
+  if ((status = OpenJsonTape(mapping, size, root)) != FUNC_SUCCESS)
+  {
+    munmap(mapping, size);
+    return status;
+  }
+
+  file->mapping = mapping;
+  file->size = size;
+  return FUNC_SUCCESS;
+}
+
+void UnloadJsonTape(tape_file_json_t *file)
+{
+  if (file->mapping != nullptr)
+    munmap(file->mapping, file->size);
+  file->mapping = nullptr;
+  file->size = 0;
+}
+
+status_json_t GetTapeProperty(tape_json_t src, tape_json_t *dest,
+                              const char *target)
+{
+  if (src.type != JOBJECT && src.type != JARRAY)
+    return UNSUPPORTED_OPERATION;
+
+  const size_t end = GetContainerEnd(&src);
+  if (end == 0)
+    return UNSUPPORTED_OPERATION;
+
+  // Descendants follow their container, so walking forward visits every key
+  // in document order
+  const size_t targetLength = strlen(target);
+  size_t offset = src.offset + CONTAINER_NODE_SIZE;
+  while (offset < end)
+  {
+    const size_t size = GetNodeSize(src.tape, end, offset);
+    if (size == 0)
+      return UNSUPPORTED_OPERATION;
+
+    if (src.tape[offset] == TAPE_KEY &&
+        size - STRING_NODE_OVERHEAD == targetLength &&
+        memcmp(&src.tape[offset + 5], target, targetLength) == 0)
+    {
+      return ReadValue(src.tape, end, offset + size, dest);
+    }
+    offset += size;
+  }
+
+  return UNDEFINED_KEY;
+}
+
+status_json_t GetTapeString(tape_json_t src, const char **dest,
+                            size_t *length)
+{
+  if (src.type != JSTRING)
+    return UNSUPPORTED_OPERATION;
+
+  *length = ReadU32(&src.tape[src.offset + 1]);
+  *dest = (const char *)&src.tape[src.offset + 5];
+  return FUNC_SUCCESS;
+}
+
+status_json_t ConvertTapeToString(tape_json_t src, char *dest)
+{
+  double value;
+  int64_t integer;
+  bool isInteger;
+
+  switch (src.type)
+  {
+  case JSTRING:
+    // Reloaded tapes may hold strings of any length
+    const size_t length = ReadU32(&src.tape[src.offset + 1]);
+    if (length >= JSONBUFFSIZE)
+      return MEMORY_FAILURE;
+
+    memcpy(dest, &src.tape[src.offset + 5], length + 1);
+    break;
+
+  case JNUMBER:
+    ReadNumber(&src, &value, &integer, &isInteger);
+    if (isInteger)
+    {
+      snprintf(dest, BUFSIZ, "%lld", (long long)integer);
+      break;
+    }
+
+    // Shortest precision that reads back as the same double
+    for (int precision = 15; precision <= 17; precision++)
+    {
+      snprintf(dest, BUFSIZ, "%.*g", precision, value);
+      if (strtod(dest, nullptr) == value)
+        break;
+    }
+    break;
+
+  case JBOOLEAN:
+    strcpy(dest, src.tape[src.offset + 1] ? "true" : "false");
+    break;
+
+  case JNULL:
+    strcpy(dest, "null");
+    break;
+
+  default:
+    return UNSUPPORTED_OPERATION;
+  }
+
+  return FUNC_SUCCESS;
+}
+
+status_json_t ConvertTapeToStandardType(tape_json_t json,
+                                        native_json_type_t type, void *dest)
+{
+  double value;
+  int64_t integer;
+  bool isInteger;
+  status_json_t status;
+
+  switch (type)
+  {
+  case JSON_DOUBLE:
+    if (json.type != JNUMBER)
+      return UNSUPPORTED_OPERATION;
+
+    ReadNumber(&json, &value, &integer, &isInteger);
+    *(double *)dest = value;
+    break;
+
+  case JSON_LONG:
+    if ((status = ReadInteger(&json, LONG_MIN, LONG_MAX, &integer)) !=
+        FUNC_SUCCESS)
+    {
+      return status;
+    }
+
+    *(long *)dest = (long)integer;
+    break;
+
+  case JSON_INT:
+    if ((status = ReadInteger(&json, INT_MIN, INT_MAX, &integer)) !=
+        FUNC_SUCCESS)
+    {
+      return status;
+    }
+
+    *(int *)dest = (int)integer;
+    break;
+
+  case JSON_BOOLEAN:
+    if (json.type != JBOOLEAN)
+      return UNSUPPORTED_OPERATION;
+
+    *(bool *)dest = json.tape[json.offset + 1] != 0;
+    break;
+
+  case JSON_DOUBLE_ARR:
+  case JSON_LONG_ARR:
+  case JSON_INT_ARR:
+    return ConvertTapeArray(&json, type, (array_json_t *)dest);
+
+  case JSON_CHAR_ARR:
+    return ConvertTapeToString(json, dest);
+  }
+
+  return FUNC_SUCCESS;
+}
@@ -0,0 +1,209 @@
+#include "json_internal.h"
+
+// On-demand access: a view is a pointer to the first byte of a value plus the
+// bytes available from there. Values are only scanned when a getter or a
+// cursor needs them, and only as far as needed, so unused members are skipped
+// without being decoded, copied or validated
+
+// Private members
+
+static type_json_t GetViewType(const char c)
+{
+  switch (c)
+  {
+  case CURLY_OPEN:
+    return JOBJECT;
+  case SQUARE_OPEN:
+    return JARRAY;
+  case DOUBLE_QUOTES:
+    return JSTRING;
+  case 't':
+  case 'f':
+    return JBOOLEAN;
+  case 'n':
+    return JNULL;
+  default:
+    return c == MINUS || isdigit((unsigned char)c) ? JNUMBER : JUNDEFINED;
+  }
+}
+
+static status_json_t ReadView(const char *str, size_t i, const size_t length,
+                              json_view_t *dest)
+{
+  i = SkipWhitespace(str, i, length);
+  if (i >= length)
+    return UNSUPPORTED_OPERATION;
+
+  dest->str = &str[i];
+  dest->length = length - i;
+  dest->type = GetViewType(str[i]);
+  return dest->type == JUNDEFINED ? UNSUPPORTED_OPERATION : FUNC_SUCCESS;
+}
+
+// Moves past the value handed out last and the comma that follows it
+static status_json_t AdvanceCursor(json_cursor_t *cursor)
+{
+  size_t i = cursor->position;
+  if (cursor->isPending)
+  {
+    const size_t end = SkipValue(cursor->str, i, cursor->length);
+    if (end == i)
+      return UNSUPPORTED_OPERATION;
+    i = end;
+    cursor->isPending = false;
+  }
+
+  i = SkipWhitespace(cursor->str, i, cursor->length);
+  if (i >= cursor->length)
+    return UNSUPPORTED_OPERATION;
+
+  if (cursor->str[i] ==
+      (cursor->type == JOBJECT ? CURLY_CLOSE : SQUARE_CLOSE))
+  {
+    cursor->position = i;
+    return UNDEFINED_KEY;
+  }
+
+  if (cursor->str[i] == COMMA)
+    i = SkipWhitespace(cursor->str, i + 1, cursor->length);
+
+  cursor->position = i;
+  return i < cursor->length ? FUNC_SUCCESS : UNSUPPORTED_OPERATION;
+}
+
+// Public members
+
+status_json_t ViewJson(const char *src, const size_t length, json_view_t *dest)
+{
+  return ReadView(src, 0, length, dest);
+}
+
+status_json_t ViewIterate(json_view_t container, json_cursor_t *cursor)
+{
+  if (container.type != JOBJECT && container.type != JARRAY)
+    return UNSUPPORTED_OPERATION;
+
+  cursor->str = container.str;
+  cursor->length = container.length;
+  cursor->position = 1;
+  cursor->type = container.type;
+  cursor->isPending = false;
+  return FUNC_SUCCESS;
+}
+
+status_json_t ViewNextItem(json_cursor_t *cursor, json_view_t *dest)
+{
+  status_json_t status;
+  if (cursor->type != JARRAY)
+    return UNSUPPORTED_OPERATION;
+  if ((status = AdvanceCursor(cursor)) != FUNC_SUCCESS ||
+      (status = ReadView(cursor->str, cursor->position, cursor->length,
+                         dest)) != FUNC_SUCCESS)
+  {
+    return status;
+  }
+
+  cursor->isPending = true;
+  return FUNC_SUCCESS;
+}
+
+status_json_t ViewNextField(json_cursor_t *cursor, json_view_t *key,
+                            json_view_t *value)
+{
+  status_json_t status;
+  if (cursor->type != JOBJECT)
+    return UNSUPPORTED_OPERATION;
+  if ((status = AdvanceCursor(cursor)) != FUNC_SUCCESS)
+    return status;
+
+  const size_t iKey = cursor->position;
+  const size_t iKeyEnd = SkipValue(cursor->str, iKey, cursor->length);
+  if (cursor->str[iKey] != DOUBLE_QUOTES || iKeyEnd == iKey)
+    return UNSUPPORTED_OPERATION;
+
+  const size_t iColon = SkipWhitespace(cursor->str, iKeyEnd, cursor->length);
+  if (iColon >= cursor->length || cursor->str[iColon] != COLON ||
+      ReadView(cursor->str, iColon + 1, cursor->length, value) != FUNC_SUCCESS)
+  {
+    return UNSUPPORTED_OPERATION;
+  }
+
+  key->str = &cursor->str[iKey];
+  key->length = iKeyEnd - iKey;
+  key->type = JSTRING;
+  cursor->position = value->str - cursor->str;
+  cursor->isPending = true;
+  return FUNC_SUCCESS;
+}
+
+status_json_t ViewGetField(json_view_t object, const char *target,
+                           json_view_t *dest)
+{
+  json_cursor_t cursor;
+  json_view_t key;
+  status_json_t status;
+  if ((status = ViewIterate(object, &cursor)) != FUNC_SUCCESS)
+    return status;
+
+  const size_t targetLength = strlen(target);
+  while ((status = ViewNextField(&cursor, &key, dest)) == FUNC_SUCCESS)
+  {
+    // Keys are compared as written, without their double quotes
+    if (key.length - 2 == targetLength &&
+        memcmp(&key.str[1], target, targetLength) == 0)
+    {
+      return FUNC_SUCCESS;
+    }
+  }
+
+  return status;
+}
+
+status_json_t ViewGetString(json_view_t view, const char **dest,
+                            size_t *length)
+{
+  if (view.type != JSTRING)
+    return UNSUPPORTED_OPERATION;
+
+  const size_t end = SkipValue(view.str, 0, view.length);
+  if (end == 0)
+    return UNSUPPORTED_OPERATION;
+
+  *dest = &view.str[1];
+  *length = end - 2;
+  return FUNC_SUCCESS;
+}
+
+status_json_t ViewGetDouble(json_view_t view, double *dest)
+{
+  bool isInteger;
+  const size_t end = ScanNumber(view.str, 0, view.length, &isInteger);
+  if (view.type != JNUMBER || end == 0)
+    return UNSUPPORTED_OPERATION;
+
+  return ParseJsonDouble(view.str, end, dest);
+}
+
+status_json_t ViewGetLong(json_view_t view, long *dest)
+{
+  bool isInteger;
+  const size_t end = ScanNumber(view.str, 0, view.length, &isInteger);
+  if (view.type != JNUMBER || end == 0)
+    return UNSUPPORTED_OPERATION;
+
+  return ParseJsonLong(view.str, end, dest);
+}
+
+status_json_t ViewGetBoolean(json_view_t view, bool *dest)
+{
+  if (view.type != JBOOLEAN)
+    return UNSUPPORTED_OPERATION;
+
+  if (view.length >= 4 && memcmp(view.str, "true", 4) == 0)
+    *dest = true;
+  else if (view.length >= 5 && memcmp(view.str, "false", 5) == 0)
+    *dest = false;
+  else
+    return UNSUPPORTED_OPERATION;
+  return FUNC_SUCCESS;
+}
@@ -0,0 +1,171 @@
+#define _POSIX_C_SOURCE 200809L
+#include <json.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+constexpr size_t DEFAULT_MAX_THREADS = 64;
+constexpr size_t DEFAULT_ITERATIONS = 20000;
+
+// Thread stacks are deliberately small: the parser API must not need more
+// than one by-value string_json_t, whose size depends on the profile
+constexpr size_t THREAD_STACK_SIZE = 64 * 1024 + sizeof(string_json_t);
+
+typedef struct
+{
+  const char *key;
+  const char *expected;
+} query_t;
+
+typedef struct
+{
+  const string_json_t *document;
+  size_t iterations;
+  size_t operations;
+  size_t failures;
+  json_parser_t parser;
+  string_json_t result;
+} worker_t;
+
+static const query_t QUERIES[] = {
+    {"progName", "library"},
+    {"version", "1.0"},
+    {"isCompliant", "false"},
+    {"lastUpdated", "null"},
+    {"other", "{}"},
+    {"tags", "[\"C\", \"C++\"]"},
+};
+constexpr size_t COUNT_QUERIES = sizeof(QUERIES) / sizeof(QUERIES[0]);
+
+static double GetSeconds()
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (double)now.tv_sec + (double)now.tv_nsec / 1e9;
+}
+
+static void *RunWorker(void *data)
+{
+  worker_t *worker = (worker_t *)data;
+  char cResult[512];
+  InitJsonParser(&worker->parser);
+
+  for (size_t n = 0; n < worker->iterations; n++)
+  {
+    const query_t *query = &QUERIES[n % COUNT_QUERIES];
+    if (ParserGetProperty(&worker->parser, worker->document, &worker->result,
+                          query->key) != FUNC_SUCCESS ||
+        ConvertJsonToString(worker->result, cResult) != FUNC_SUCCESS ||
+        strcmp(cResult, query->expected) != 0)
+    {
+      worker->failures++;
+    }
+    worker->operations++;
+  }
+
+  return nullptr;
+}
+
+// Runs one round with the given amount of threads and returns ops per second
+static double RunRound(const string_json_t *document, worker_t *workers,
+                       const size_t threads, const size_t iterations,
+                       size_t *failures)
+{
+  pthread_t handles[threads];
+  pthread_attr_t attributes;
+  pthread_attr_init(&attributes);
+  pthread_attr_setstacksize(&attributes, THREAD_STACK_SIZE);
+
+  const double startTime = GetSeconds();
+  for (size_t t = 0; t < threads; t++)
+  {
+    workers[t].document = document;
+    workers[t].iterations = iterations;
+    workers[t].operations = 0;
+    workers[t].failures = 0;
+    if (pthread_create(&handles[t], &attributes, RunWorker, &workers[t]) != 0)
+    {
+      fprintf(stderr, "Failed to start thread %zu\n", t);
+      exit(EXIT_FAILURE);
+    }
+  }
+
+  size_t operations = 0;
+  for (size_t t = 0; t < threads; t++)
+  {
+    pthread_join(handles[t], nullptr);
+    operations += workers[t].operations;
+    *failures += workers[t].failures;
+  }
+  const double elapsed = GetSeconds() - startTime;
+
+  pthread_attr_destroy(&attributes);
+  return (double)operations / elapsed;
+}
+
+int main(int argc, char **argv)
+{
+  const size_t maxThreads =
+      argc > 1 ? strtoul(argv[1], nullptr, 10) : DEFAULT_MAX_THREADS;
+  const size_t iterations =
+      argc > 2 ? strtoul(argv[2], nullptr, 10) : DEFAULT_ITERATIONS;
+  if (maxThreads == 0 || iterations == 0)
+  {
+    fprintf(stderr, "Usage: %s [max threads] [iterations per thread]\n",
+            argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  const char cJsonStr[] =
+      "{ \"progName\": \"library\", \"description\": \"\","
+      "\"version\": 1.0, \"tags\": "
+      "[\"C\", \"C++\"], \"metadata\": { \"origin\": "
+      "\"unknown\", \"device\": { \"pc\": \"Desktop\" } }, "
+      "\"displays\": [{ \"name\": \"HDMI-A-1\" }, { \"name\": \"HDMI-A-2\" }], "
+      "\"isCompliant\": false, \"lastUpdated\": null, \"devs\": "
+      "[], \"other\": {} }";
+
+  // Shared by every thread and never written to after this point
+  string_json_t *document = calloc(1, sizeof(string_json_t));
+  worker_t *workers = calloc(maxThreads, sizeof(worker_t));
+  if (document == nullptr || workers == nullptr ||
+      ConvertStringToJson(cJsonStr, document) != FUNC_SUCCESS)
+  {
+    return EXIT_FAILURE;
+  }
+
+  printf("threads,ops_per_sec,scaling\n");
+  size_t failures = 0;
+  double baseline = 0;
+  for (size_t threads = 1; threads <= maxThreads;
+       threads = threads * 2 > maxThreads && threads != maxThreads
+                     ? maxThreads
+                     : threads * 2)
+  {
+    const double throughput =
+        RunRound(document, workers, threads, iterations, &failures);
+    if (threads == 1)
+    {
+      baseline = throughput;
+    }
+    printf("%zu,%.0f,%.2f\n", threads, throughput, throughput / baseline);
+  }
+
+  for (size_t i = 0; i < maxThreads; i++)
+  {
+    FreeJsonParser(&workers[i].parser);
+    FreeJsonString(&workers[i].result);
+  }
+  FreeJsonString(document);
+  free(workers);
+  free(document);
+
+  if (failures > 0)
+  {
+    fprintf(stderr, "%zu lookups returned unexpected results\n", failures);
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
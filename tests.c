@@ -1,11 +1,12 @@
 #include <assert.h>
 #include <json.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <time.h>
 
 constexpr char CHECKMARK[] = "\xE2\x9C\x93\n";
-constexpr unsigned char COUNT_CASES = 13;
+constexpr unsigned char COUNT_CASES = 48;
 static unsigned char tests = 0;
 
 #define tryAssert(a, b, c)                                                     \
@@ -33,7 +34,7 @@ static void tryAssertShort(short case1, short case2, const char *message)
 
 static status_json_t Test_String(string_json_t json)
 {
-  string_json_t result;
+  string_json_t result = {};
   status_json_t status;
   if ((status = GetProperty(json, &result, "progName")) != FUNC_SUCCESS)
   {
@@ -48,12 +49,13 @@ static status_json_t Test_String(string_json_t json)
 
   tryAssert(cResult, "library", "String");
 
+  FreeJsonString(&result);
   return FUNC_SUCCESS;
 }
 
 static status_json_t Test_Empty_String(string_json_t json)
 {
-  string_json_t result;
+  string_json_t result = {};
   status_json_t status;
   if ((status = GetProperty(json, &result, "description")) != FUNC_SUCCESS)
   {
@@ -68,12 +70,13 @@ static status_json_t Test_Empty_String(string_json_t json)
 
   tryAssert(cResult, "", "Empty String");
 
+  FreeJsonString(&result);
   return FUNC_SUCCESS;
 }
 
 static status_json_t Test_Primitive_Empty_String(string_json_t json)
 {
-  string_json_t result;
+  string_json_t result = {};
   status_json_t status;
   if ((status = GetProperty(json, &result, "description")) != FUNC_SUCCESS)
   {
@@ -89,12 +92,13 @@ static status_json_t Test_Primitive_Empty_String(string_json_t json)
 
   tryAssert(array, "", "Primitive Empty String");
 
+  FreeJsonString(&result);
   return FUNC_SUCCESS;
 }
 
 static status_json_t Test_Boolean(string_json_t json)
 {
-  string_json_t result;
+  string_json_t result = {};
   status_json_t status;
   if ((status = GetProperty(json, &result, "isCompliant")) != FUNC_SUCCESS)
   {
@@ -109,12 +113,13 @@ static status_json_t Test_Boolean(string_json_t json)
 
   tryAssert(cResult, "false", "Boolean");
 
+  FreeJsonString(&result);
   return FUNC_SUCCESS;
 }
 
 static status_json_t Test_Null(string_json_t json)
 {
-  string_json_t result;
+  string_json_t result = {};
   status_json_t status;
   if ((status = GetProperty(json, &result, "lastUpdated")) != FUNC_SUCCESS)
   {
@@ -128,12 +133,13 @@ static status_json_t Test_Null(string_json_t json)
   }
 
   tryAssert(cResult, "null", "Null");
+  FreeJsonString(&result);
   return FUNC_SUCCESS;
 }
 
 static status_json_t Test_Number(string_json_t json)
 {
-  string_json_t result;
+  string_json_t result = {};
   status_json_t status;
   if ((status = GetProperty(json, &result, "version")) != FUNC_SUCCESS)
   {
@@ -147,12 +153,13 @@ static status_json_t Test_Number(string_json_t json)
   }
 
   tryAssert(cResult, "1.0", "Number");
+  FreeJsonString(&result);
   return FUNC_SUCCESS;
 }
 
 static status_json_t Test_Array(string_json_t json)
 {
-  string_json_t result;
+  string_json_t result = {};
   status_json_t status;
   if ((status = GetProperty(json, &result, "tags")) != FUNC_SUCCESS)
   {
@@ -167,12 +174,13 @@ static status_json_t Test_Array(string_json_t json)
 
   tryAssert(cResult, "[\"C\", \"C++\"]", "Array");
 
+  FreeJsonString(&result);
   return FUNC_SUCCESS;
 }
 
 static status_json_t Test_Empty_Array(string_json_t json)
 {
-  string_json_t result;
+  string_json_t result = {};
   status_json_t status;
   if ((status = GetProperty(json, &result, "devs")) != FUNC_SUCCESS)
   {
@@ -187,12 +195,13 @@ static status_json_t Test_Empty_Array(string_json_t json)
 
   tryAssert(cResult, "[]", "Empty Array");
 
+  FreeJsonString(&result);
   return FUNC_SUCCESS;
 }
 
 static status_json_t Test_Object(string_json_t json)
 {
-  string_json_t result;
+  string_json_t result = {};
   status_json_t status;
   if ((status = GetProperty(json, &result, "metadata")) != FUNC_SUCCESS)
   {
@@ -209,12 +218,13 @@ static status_json_t Test_Object(string_json_t json)
             "{ \"origin\": \"unknown\", \"device\": { \"pc\": \"Desktop\" } }",
             "Object");
 
+  FreeJsonString(&result);
   return FUNC_SUCCESS;
 }
 
 static status_json_t Test_Empty_Object(string_json_t json)
 {
-  string_json_t result;
+  string_json_t result = {};
   status_json_t status;
   if ((status = GetProperty(json, &result, "other")) != FUNC_SUCCESS)
   {
@@ -229,12 +239,13 @@ static status_json_t Test_Empty_Object(string_json_t json)
 
   tryAssert(cResult, "{}", "Empty Object");
 
+  FreeJsonString(&result);
   return FUNC_SUCCESS;
 }
 
 static status_json_t Test_Nested_Object(string_json_t json)
 {
-  string_json_t result;
+  string_json_t result = {};
   status_json_t status;
   if ((status = GetProperty(json, &result, "device")) != FUNC_SUCCESS)
   {
@@ -249,12 +260,13 @@ static status_json_t Test_Nested_Object(string_json_t json)
 
   tryAssert(cResult, "{ \"pc\": \"Desktop\" }", "Object nested");
 
+  FreeJsonString(&result);
   return FUNC_SUCCESS;
 }
 
 static status_json_t Test_Missing_Key(string_json_t json)
 {
-  string_json_t result;
+  string_json_t result = {};
   status_json_t status;
   if ((status = GetProperty(json, &result, "undefinedKey")) != FUNC_SUCCESS)
   {
@@ -262,6 +274,7 @@ static status_json_t Test_Missing_Key(string_json_t json)
     return FUNC_SUCCESS;
   }
 
+  FreeJsonString(&result);
   return UNSUPPORTED_OPERATION;
 }
 
@@ -276,7 +289,7 @@ static void ConcatArray(char *item, size_t, void *data)
 
 static status_json_t Test_Array_Concat(string_json_t json)
 {
-  string_json_t result;
+  string_json_t result = {};
   status_json_t status;
 
   if ((status = GetProperty(json, &result, "displays")) != FUNC_SUCCESS)
@@ -292,6 +305,1220 @@ static status_json_t Test_Array_Concat(string_json_t json)
   tryAssert(cResult, "{ \"name\": \"HDMI-A-1\" }{ \"name\": \"HDMI-A-2\" }",
             "Array Concatenation");
 
+  FreeJsonString(&result);
+  return FUNC_SUCCESS;
+}
+
+static status_json_t Test_Pretty_Number(string_json_t json)
+{
+  string_json_t result = {};
+  status_json_t status;
+  if ((status = GetProperty(json, &result, "version")) != FUNC_SUCCESS)
+  {
+    return status;
+  }
+
+  char cResult[512];
+  if ((status = ConvertJsonToString(result, cResult)) != FUNC_SUCCESS)
+  {
+    return status;
+  }
+
+  tryAssert(cResult, "2.5", "Pretty-printed Number");
+  FreeJsonString(&result);
+  return FUNC_SUCCESS;
+}
+
+static status_json_t Test_Pretty_Boolean(string_json_t json)
+{
+  string_json_t result = {};
+  status_json_t status;
+  if ((status = GetProperty(json, &result, "isCompliant")) != FUNC_SUCCESS)
+  {
+    return status;
+  }
+
+  char cResult[512];
+  if ((status = ConvertJsonToString(result, cResult)) != FUNC_SUCCESS)
+  {
+    return status;
+  }
+
+  tryAssert(cResult, "true", "Pretty-printed Boolean");
+  FreeJsonString(&result);
+  return FUNC_SUCCESS;
+}
+
+static status_json_t Test_Pretty_Array_Concat(string_json_t json)
+{
+  string_json_t result = {};
+  status_json_t status;
+
+  if ((status = GetProperty(json, &result, "tags")) != FUNC_SUCCESS)
+  {
+    return status;
+  }
+
+  result.str[result.length] = '\0';
+
+  char cResult[512] = {};
+  MapStringArray(ConcatArray, result.str, cResult, result.length);
+
+  tryAssert(cResult, "CC++", "Pretty-printed Array Concatenation");
+
+  FreeJsonString(&result);
+  return FUNC_SUCCESS;
+}
+
+static status_json_t Test_Parser_In_Place(string_json_t json)
+{
+  json_parser_t *parser = malloc(sizeof(json_parser_t));
+  if (parser == nullptr)
+  {
+    return MEMORY_FAILURE;
+  }
+  InitJsonParser(parser);
+
+  // Queries in place overwrite the document, and copies of a dynamic string
+  // share its buffer, so they run on a copy of their own
+  string_json_t copy = {};
+  status_json_t status;
+  if ((status = ReserveJsonString(&copy, json.length)) != FUNC_SUCCESS)
+  {
+    free(parser);
+    return status;
+  }
+  memcpy(copy.str, json.str, json.length);
+  copy.length = json.length;
+
+  if ((status = ParserGetProperty(parser, &copy, &copy, "metadata")) !=
+          FUNC_SUCCESS ||
+      (status = ParserGetProperty(parser, &copy, &copy, "device")) !=
+          FUNC_SUCCESS)
+  {
+    FreeJsonParser(parser);
+    free(parser);
+    FreeJsonString(&copy);
+    return status;
+  }
+  FreeJsonParser(parser);
+  free(parser);
+
+  char cResult[512];
+  if ((status = ConvertJsonToString(copy, cResult)) != FUNC_SUCCESS)
+  {
+    FreeJsonString(&copy);
+    return status;
+  }
+
+  tryAssert(cResult, "{ \"pc\": \"Desktop\" }", "Parser in place");
+
+  FreeJsonString(&copy);
+  return FUNC_SUCCESS;
+}
+
+static status_json_t Test_Parser_Depth(string_json_t)
+{
+  json_parser_t *parser = malloc(sizeof(json_parser_t));
+  if (parser == nullptr)
+    return MEMORY_FAILURE;
+  InitJsonParser(parser);
+
+  string_json_t document = {}, result = {};
+  char cResult[64] = "";
+  status_json_t status =
+      ConvertStringToJson("{\"a\": {\"b\": {\"c\": 1}}, \"d\": 2}", &document);
+  if (status == FUNC_SUCCESS &&
+      (status = ParserGetProperty(parser, &document, &result, "d")) ==
+          FUNC_SUCCESS)
+  {
+    ConvertJsonToString(result, cResult);
+    parser->maxDepth = 2;
+    snprintf(&cResult[strlen(cResult)], sizeof(cResult) - strlen(cResult),
+             " %d", ParserGetProperty(parser, &document, &result, "d"));
+  }
+  FreeJsonParser(parser);
+  free(parser);
+  FreeJsonString(&document);
+  FreeJsonString(&result);
+  if (status != FUNC_SUCCESS)
+    return status;
+
+  char cExpected[64];
+  snprintf(cExpected, sizeof(cExpected), "2 %d", MEMORY_FAILURE);
+  tryAssert(cResult, cExpected, "Parser depth");
+  return FUNC_SUCCESS;
+}
+
+static status_json_t Test_Stats(string_json_t json)
+{
+  string_json_t result = {};
+  status_json_t status;
+  ResetJsonStats();
+  if ((status = GetProperty(json, &result, "version")) != FUNC_SUCCESS)
+  {
+    return status;
+  }
+
+  stats_json_t stats;
+  if ((status = GetJsonStats(&stats)) == UNSUPPORTED_OPERATION)
+  {
+    tryAssert(status, UNSUPPORTED_OPERATION, "Stats compiled out");
+    FreeJsonString(&result);
+    return FUNC_SUCCESS;
+  }
+
+  assert(stats.getProperty.calls == 1 && stats.getValue.calls == 1);
+  assert(stats.bytesScanned > 0 && stats.bytesCopied == result.length);
+  tryAssert((short)stats.keysCompared, 3, "Stats");
+
+  FreeJsonString(&result);
+  return FUNC_SUCCESS;
+}
+
+static status_json_t Test_Escaped_String(string_json_t json)
+{
+  string_json_t result = {};
+  status_json_t status;
+  if ((status = GetProperty(json, &result, "quote")) != FUNC_SUCCESS)
+  {
+    return status;
+  }
+
+  char cResult[512];
+  if ((status = ConvertJsonToString(result, cResult)) != FUNC_SUCCESS)
+  {
+    return status;
+  }
+
+  tryAssert(cResult, "a\\\"b\\\\", "Escaped String");
+
+  FreeJsonString(&result);
+  return FUNC_SUCCESS;
+}
+
+static status_json_t Test_Two_Character_String(string_json_t json)
+{
+  string_json_t result = {};
+  status_json_t status;
+  if ((status = GetProperty(json, &result, "id")) != FUNC_SUCCESS)
+  {
+    return status;
+  }
+
+  char cResult[512];
+  if ((status = ConvertJsonToString(result, cResult)) != FUNC_SUCCESS)
+  {
+    return status;
+  }
+
+  tryAssert(cResult, "ab", "Two-character String");
+
+  FreeJsonString(&result);
+  return FUNC_SUCCESS;
+}
+
+static status_json_t Test_Negative_Exponent_Number(string_json_t json)
+{
+  string_json_t result = {};
+  status_json_t status;
+  if ((status = GetProperty(json, &result, "temperature")) != FUNC_SUCCESS)
+  {
+    return status;
+  }
+
+  char cResult[512];
+  if ((status = ConvertJsonToString(result, cResult)) != FUNC_SUCCESS)
+  {
+    return status;
+  }
+
+  tryAssert(cResult, "-1.5e3", "Negative Number with Exponent");
+  FreeJsonString(&result);
+  return FUNC_SUCCESS;
+}
+
+static status_json_t Test_Nested_Boolean(string_json_t json)
+{
+  string_json_t result = {};
+  status_json_t status;
+  if ((status = GetProperty(json, &result, "on")) != FUNC_SUCCESS)
+  {
+    return status;
+  }
+
+  char cResult[512];
+  if ((status = ConvertJsonToString(result, cResult)) != FUNC_SUCCESS)
+  {
+    return status;
+  }
+
+  tryAssert(cResult, "true", "Boolean nested");
+  FreeJsonString(&result);
+  return FUNC_SUCCESS;
+}
+
+static status_json_t Test_Array_Item_Not_Key(string_json_t json)
+{
+  string_json_t result = {};
+  status_json_t status;
+  if ((status = GetProperty(json, &result, "c")) != FUNC_SUCCESS)
+  {
+    return status;
+  }
+
+  char cResult[512];
+  if ((status = ConvertJsonToString(result, cResult)) != FUNC_SUCCESS)
+  {
+    return status;
+  }
+
+  tryAssert(cResult, "0", "Array item is not a key");
+  FreeJsonString(&result);
+  return FUNC_SUCCESS;
+}
+
+static status_json_t Test_Nested_Array_Concat(string_json_t json)
+{
+  string_json_t result = {};
+  status_json_t status;
+
+  if ((status = GetProperty(json, &result, "rows")) != FUNC_SUCCESS)
+  {
+    return status;
+  }
+
+  result.str[result.length] = '\0';
+
+  char cResult[512] = {};
+  MapStringArray(ConcatArray, result.str, cResult, result.length);
+
+  tryAssert(cResult, "[1, [2]][\"]\"]", "Nested Array Concatenation");
+
+  FreeJsonString(&result);
+  return FUNC_SUCCESS;
+}
+
+static status_json_t Test_Cache(string_json_t json)
+{
+  json_cache_t *cache = malloc(sizeof(json_cache_t));
+  string_json_t *copy = malloc(sizeof(string_json_t));
+  if (cache == nullptr || copy == nullptr)
+  {
+    free(cache);
+    free(copy);
+    return MEMORY_FAILURE;
+  }
+  InitJsonCache(cache);
+  *copy = json;
+
+  // The copy holds the same content, so it reuses the results of json
+  string_json_t result = {};
+  status_json_t status;
+  if ((status = CachedGetProperty(cache, &json, &result, "version")) !=
+          FUNC_SUCCESS ||
+      (status = CachedGetProperty(cache, copy, &result, "version")) !=
+          FUNC_SUCCESS ||
+      (status = CachedGetProperty(cache, &json, &result, "other")) !=
+          FUNC_SUCCESS ||
+      CachedGetProperty(cache, &json, &result, "missing") != UNDEFINED_KEY ||
+      CachedGetProperty(cache, &json, &result, "missing") != UNDEFINED_KEY)
+  {
+    free(cache);
+    free(copy);
+    return status != FUNC_SUCCESS ? status : UNDEFINED_KEY;
+  }
+
+  char cResult[512];
+  ConvertJsonToString(result, cResult);
+  snprintf(&cResult[strlen(cResult)], sizeof(cResult) - strlen(cResult),
+           " %llu/%llu", cache->hits, cache->misses);
+  free(cache);
+  free(copy);
+
+  tryAssert(cResult, "{} 1/4", "Cache");
+
+  FreeJsonString(&result);
+  return FUNC_SUCCESS;
+}
+
+// Refilling the bound buffer keeps its address and length, so the cached
+// offsets must be confirmed against the new content
+static status_json_t Test_Cache_Refill(string_json_t)
+{
+  const char *documents[] = {"{\"a\": 1, \"b\": 22}", "{\"c\": 3, \"b\": 44}",
+                             "{\"b\": 5, \"a\": 66}"};
+  const char *keys[][2] = {{"b", "c"}, {"b", "c"}, {"b", nullptr}};
+  json_cache_t *cache = malloc(sizeof(json_cache_t));
+  if (cache == nullptr)
+    return MEMORY_FAILURE;
+  InitJsonCache(cache);
+
+  string_json_t document = {}, result = {};
+  char cResult[64] = "", cValue[16];
+  status_json_t status = ConvertStringToJson(documents[0], &document);
+  for (size_t d = 0; d < 3 && status == FUNC_SUCCESS; d++)
+  {
+    memcpy(document.str, documents[d], document.length);
+    for (size_t k = 0; k < 2 && keys[d][k] != nullptr; k++)
+    {
+      if (CachedGetProperty(cache, &document, &result, keys[d][k]) ==
+          FUNC_SUCCESS)
+      {
+        ConvertJsonToString(result, cValue);
+        strcat(cResult, cValue);
+        strcat(cResult, " ");
+      }
+    }
+  }
+  snprintf(&cResult[strlen(cResult)], sizeof(cResult) - strlen(cResult),
+           "%llu/%llu", cache->hits, cache->misses);
+  free(cache);
+  FreeJsonString(&document);
+  FreeJsonString(&result);
+  if (status != FUNC_SUCCESS)
+    return status;
+
+  tryAssert(cResult, "22 44 3 5 1/4", "Cache refill");
+  return FUNC_SUCCESS;
+}
+
+static status_json_t Test_View_Fields(string_json_t json)
+{
+  json_view_t root, metadata, device, pc, version, compliant;
+  status_json_t status;
+  if ((status = ViewJson(json.str, json.length, &root)) != FUNC_SUCCESS ||
+      (status = ViewGetField(root, "metadata", &metadata)) != FUNC_SUCCESS ||
+      (status = ViewGetField(metadata, "device", &device)) != FUNC_SUCCESS ||
+      (status = ViewGetField(device, "pc", &pc)) != FUNC_SUCCESS ||
+      (status = ViewGetField(root, "version", &version)) != FUNC_SUCCESS ||
+      (status = ViewGetField(root, "isCompliant", &compliant)) !=
+          FUNC_SUCCESS)
+  {
+    return status;
+  }
+
+  const char *name;
+  size_t nameLength;
+  double number;
+  bool flag;
+  if ((status = ViewGetString(pc, &name, &nameLength)) != FUNC_SUCCESS ||
+      (status = ViewGetDouble(version, &number)) != FUNC_SUCCESS ||
+      (status = ViewGetBoolean(compliant, &flag)) != FUNC_SUCCESS)
+  {
+    return status;
+  }
+
+  char cResult[512];
+  snprintf(cResult, sizeof(cResult), "%.*s %.1f %d", (int)nameLength, name,
+           number, flag);
+  tryAssert(cResult, "Desktop 1.0 0", "View fields");
+
+  return FUNC_SUCCESS;
+}
+
+static status_json_t Test_View_Iteration(string_json_t json)
+{
+  json_view_t root, displays, display, name;
+  json_cursor_t cursor;
+  status_json_t status;
+  if ((status = ViewJson(json.str, json.length, &root)) != FUNC_SUCCESS ||
+      (status = ViewGetField(root, "displays", &displays)) != FUNC_SUCCESS ||
+      (status = ViewIterate(displays, &cursor)) != FUNC_SUCCESS)
+  {
+    return status;
+  }
+
+  char cResult[512] = "";
+  while ((status = ViewNextItem(&cursor, &display)) == FUNC_SUCCESS)
+  {
+    const char *str;
+    size_t length;
+    if ((status = ViewGetField(display, "name", &name)) != FUNC_SUCCESS ||
+        (status = ViewGetString(name, &str, &length)) != FUNC_SUCCESS)
+    {
+      return status;
+    }
+    strncat(cResult, str, length);
+  }
+  if (status != UNDEFINED_KEY)
+  {
+    return status;
+  }
+
+  tryAssert(cResult, "HDMI-A-1HDMI-A-2", "View iteration");
+
+  return FUNC_SUCCESS;
+}
+
+static void *CreateTape(const string_json_t *json, size_t *length)
+{
+  if (ConvertJsonToTape(json->str, json->length, nullptr, 0, length) !=
+      FUNC_SUCCESS)
+  {
+    return nullptr;
+  }
+
+  void *tape = malloc(*length);
+  if (tape != nullptr &&
+      ConvertJsonToTape(json->str, json->length, tape, *length, length) !=
+          FUNC_SUCCESS)
+  {
+    free(tape);
+    return nullptr;
+  }
+  return tape;
+}
+
+static status_json_t Test_Tape_Lookup(string_json_t json)
+{
+  size_t length;
+  void *tape = CreateTape(&json, &length);
+  if (tape == nullptr)
+  {
+    return MEMORY_FAILURE;
+  }
+
+  tape_json_t root, result;
+  status_json_t status;
+  if ((status = OpenJsonTape(tape, length, &root)) != FUNC_SUCCESS ||
+      (status = GetTapeProperty(root, &result, "metadata")) != FUNC_SUCCESS ||
+      (status = GetTapeProperty(result, &result, "pc")) != FUNC_SUCCESS)
+  {
+    free(tape);
+    return status;
+  }
+
+  char cResult[512];
+  status = ConvertTapeToString(result, cResult);
+  free(tape);
+  if (status != FUNC_SUCCESS)
+  {
+    return status;
+  }
+
+  tryAssert(cResult, "Desktop", "Tape lookup");
+
+  return FUNC_SUCCESS;
+}
+
+static status_json_t Test_Tape_Reload(string_json_t json)
+{
+  constexpr char path[] = "tests.tape";
+  size_t length;
+  void *tape = CreateTape(&json, &length);
+  if (tape == nullptr)
+  {
+    return MEMORY_FAILURE;
+  }
+
+  status_json_t status = SaveJsonTape(tape, length, path);
+  free(tape);
+  if (status != FUNC_SUCCESS)
+  {
+    return status;
+  }
+
+  tape_file_json_t file;
+  tape_json_t root, result;
+  if ((status = LoadJsonTape(path, &file, &root)) != FUNC_SUCCESS)
+  {
+    remove(path);
+    return status;
+  }
+
+  int temperature = 0;
+  const char *quote = "";
+  size_t quoteLength;
+  if ((status = GetTapeProperty(root, &result, "temperature")) ==
+          FUNC_SUCCESS &&
+      (status = ConvertTapeToStandardType(result, JSON_INT, &temperature)) ==
+          FUNC_SUCCESS &&
+      (status = GetTapeProperty(root, &result, "quote")) == FUNC_SUCCESS)
+  {
+    status = GetTapeString(result, &quote, &quoteLength);
+  }
+
+  char cResult[512];
+  snprintf(cResult, sizeof(cResult), "%d %s", temperature, quote);
+  UnloadJsonTape(&file);
+  remove(path);
+  if (status != FUNC_SUCCESS)
+  {
+    return status;
+  }
+
+  tryAssert(cResult, "-1500 a\"b\\", "Tape reload");
+
+  return FUNC_SUCCESS;
+}
+
+// Strings of a reloaded tape are not bounded by JSONBUFFSIZE, so converting
+// one that does not fit must fail instead of overflowing the destination
+static status_json_t Test_Tape_Long_String(string_json_t)
+{
+  constexpr size_t PADDING = 70000;
+  char *text = malloc(PADDING + 16);
+  char *cValue = malloc(PADDING + 1);
+  if (text == nullptr || cValue == nullptr)
+  {
+    free(text);
+    free(cValue);
+    return MEMORY_FAILURE;
+  }
+
+  const int prefix = snprintf(text, PADDING + 16, "{\"s\": \"");
+  memset(&text[prefix], 'x', PADDING);
+  snprintf(&text[prefix + PADDING], 16, "\"}");
+
+  size_t length;
+  void *tape = nullptr;
+  tape_json_t root, result;
+  status_json_t status =
+      ConvertJsonToTape(text, strlen(text), nullptr, 0, &length);
+  if (status == FUNC_SUCCESS && (tape = malloc(length)) == nullptr)
+    status = MEMORY_FAILURE;
+  if (status == FUNC_SUCCESS &&
+      (status = ConvertJsonToTape(text, strlen(text), tape, length,
+                                  &length)) == FUNC_SUCCESS &&
+      (status = OpenJsonTape(tape, length, &root)) == FUNC_SUCCESS &&
+      (status = GetTapeProperty(root, &result, "s")) == FUNC_SUCCESS)
+  {
+    status = ConvertTapeToString(result, cValue);
+  }
+  free(text);
+  free(cValue);
+  free(tape);
+
+  char cResult[32], cExpected[32];
+  snprintf(cResult, sizeof(cResult), "%d", status);
+  snprintf(cExpected, sizeof(cExpected), "%d",
+           JSONBUFFSIZE > PADDING ? FUNC_SUCCESS : MEMORY_FAILURE);
+  tryAssert(cResult, cExpected, "Tape long string");
+  return FUNC_SUCCESS;
+}
+
+// Unpaired surrogates are valid escapes, kept as three bytes each like WTF-8
+static status_json_t Test_Tape_Surrogates(string_json_t)
+{
+  static const char *const KEYS[] = {"high", "low", "pair"};
+  string_json_t json = {};
+  status_json_t status =
+      ConvertStringToJson("{\"high\": \"\\ud83dx\", \"low\": \"\\udc00\", "
+                          "\"pair\": \"\\ud83d\\ude00\"}",
+                          &json);
+  size_t length;
+  void *tape = status == FUNC_SUCCESS ? CreateTape(&json, &length) : nullptr;
+  FreeJsonString(&json);
+  if (tape == nullptr)
+  {
+    return status != FUNC_SUCCESS ? status : MEMORY_FAILURE;
+  }
+
+  char cResult[512] = "";
+  tape_json_t root, result;
+  status = OpenJsonTape(tape, length, &root);
+  for (size_t k = 0; k < 3 && status == FUNC_SUCCESS; k++)
+  {
+    const char *text;
+    size_t textLength;
+    if ((status = GetTapeProperty(root, &result, KEYS[k])) != FUNC_SUCCESS ||
+        (status = GetTapeString(result, &text, &textLength)) != FUNC_SUCCESS)
+    {
+      break;
+    }
+    for (size_t i = 0; i < textLength; i++)
+    {
+      snprintf(&cResult[strlen(cResult)], sizeof(cResult) - strlen(cResult),
+               "%02X", (unsigned char)text[i]);
+    }
+    strcat(cResult, " ");
+  }
+  free(tape);
+  if (status != FUNC_SUCCESS)
+  {
+    return status;
+  }
+
+  tryAssert(cResult, "EDA0BD78 EDB080 F09F9880 ", "Tape lone surrogates");
+  return FUNC_SUCCESS;
+}
+
+static status_json_t Test_Number_Conversion(string_json_t json)
+{
+  string_json_t result = {};
+  status_json_t status;
+  if ((status = GetProperty(json, &result, "temperature")) != FUNC_SUCCESS)
+  {
+    return status;
+  }
+
+  double number, zero;
+  int integer;
+  if ((status = ConvertJsonToStandardType(result, JSON_DOUBLE, &number)) !=
+          FUNC_SUCCESS ||
+      (status = ConvertJsonToStandardType(result, JSON_INT, &integer)) !=
+          FUNC_SUCCESS ||
+      (status = ParseJsonDouble("-0", 2, &zero)) != FUNC_SUCCESS)
+  {
+    return status;
+  }
+
+  char cResult[512];
+  snprintf(cResult, sizeof(cResult), "%g %d %g", number, integer, zero);
+  tryAssert(cResult, "-1500 -1500 -0", "Number conversion");
+  FreeJsonString(&result);
+  return FUNC_SUCCESS;
+}
+
+static status_json_t Test_Number_Errors(string_json_t)
+{
+  double number;
+  int integer;
+  long longInteger;
+  char cResult[512];
+  snprintf(cResult, sizeof(cResult), "%d %d %d %d",
+           ParseJsonDouble("1e400", 5, &number),
+           ParseJsonInt("2147483648", 10, &integer),
+           ParseJsonLong("-9223372036854775808", 20, &longInteger),
+           ParseJsonDouble("1.5x", 4, &number));
+
+  tryAssert(cResult, "4 4 0 3", "Number errors");
+  return FUNC_SUCCESS;
+}
+
+static status_json_t Test_Number_Array(string_json_t)
+{
+  // Fixed-size arrays are too large for the stack
+  array_json_t *doubles = calloc(1, sizeof(array_json_t));
+  array_json_t *longs = calloc(1, sizeof(array_json_t));
+  if (doubles == nullptr || longs == nullptr)
+  {
+    free(doubles);
+    free(longs);
+    return MEMORY_FAILURE;
+  }
+
+  string_json_t json = {};
+  status_json_t status = ConvertStringToJson("[-1, 2.5e1, 3]", &json);
+  if (status == FUNC_SUCCESS &&
+      (status = ConvertJsonToStandardType(json, JSON_DOUBLE_ARR, doubles)) ==
+          FUNC_SUCCESS)
+  {
+    status = ConvertJsonToStandardType(json, JSON_LONG_ARR, longs);
+  }
+
+  char cResult[512] = "";
+  for (int i = 0; i < doubles->length && i < longs->length; i++)
+  {
+    snprintf(&cResult[strlen(cResult)], sizeof(cResult) - strlen(cResult),
+             "%g/%ld ", doubles->data.d[i], longs->data.l[i]);
+  }
+  snprintf(&cResult[strlen(cResult)], sizeof(cResult) - strlen(cResult),
+           "%d", doubles->length);
+  FreeJsonString(&json);
+  FreeJsonArray(doubles);
+  FreeJsonArray(longs);
+  free(doubles);
+  free(longs);
+  if (status != FUNC_SUCCESS)
+    return status;
+
+  tryAssert(cResult, "-1/-1 25/25 3/3 3", "Number array");
+  return FUNC_SUCCESS;
+}
+
+static status_json_t Test_Columns(string_json_t json)
+{
+  int x[2];
+  double y[2];
+  bool on[2], isOnPresent[2];
+  const column_json_t columns[] = {
+      {"x", JSON_INT, x, nullptr},
+      {"y", JSON_DOUBLE, y, nullptr},
+      {"on", JSON_BOOLEAN, on, isOnPresent},
+  };
+
+  json_view_t root, points;
+  size_t rows;
+  status_json_t status;
+  if ((status = ViewJson(json.str, json.length, &root)) != FUNC_SUCCESS ||
+      (status = ViewGetField(root, "points", &points)) != FUNC_SUCCESS ||
+      (status = ExtractJsonColumns(points, columns, 3, 2, &rows)) !=
+          FUNC_SUCCESS)
+  {
+    return status;
+  }
+
+  char cResult[512];
+  snprintf(cResult, sizeof(cResult), "%zu %d,%d %g,%g %d%d %d%d", rows, x[0],
+           x[1], y[0], y[1], on[0], on[1], isOnPresent[0], isOnPresent[1]);
+  tryAssert(cResult, "2 1,3 2.5,-10 10 10", "Columns");
+  return FUNC_SUCCESS;
+}
+
+typedef struct
+{
+  _Atomic int documents;
+  _Atomic int failures;
+} ingest_count_t;
+
+static void CountDocument(const char *, const char *content, size_t length,
+                          status_json_t status, void *data)
+{
+  ingest_count_t *count = (ingest_count_t *)data;
+  json_view_t root, name;
+  if (status == FUNC_SUCCESS &&
+      ViewJson(content, length, &root) == FUNC_SUCCESS &&
+      ViewGetField(root, "progName", &name) == FUNC_SUCCESS)
+  {
+    count->documents++;
+  }
+  else if (status != FUNC_SUCCESS)
+  {
+    count->failures++;
+  }
+}
+
+static status_json_t Test_Ingest(string_json_t json)
+{
+  const char *paths[] = {"tests1.json", "tests.missing", "tests2.json"};
+  for (size_t i = 0; i < 3; i += 2)
+  {
+    FILE *file = fopen(paths[i], "wb");
+    if (file == nullptr)
+    {
+      return UNSUPPORTED_OPERATION;
+    }
+    fwrite(json.str, 1, json.length, file);
+    fclose(file);
+  }
+
+  // Once through io_uring where it is available, once with blocking reads
+  char buffers[2][1024];
+  ingest_count_t count = {0, 0};
+  ingest_options_json_t options = {CountDocument, &count, buffers[0], 2,
+                                   sizeof(buffers[0]), 2, false, 0};
+  status_json_t status = IngestJsonFiles(paths, 3, &options);
+  options.isBlocking = true;
+  if (status == FUNC_SUCCESS)
+  {
+    status = IngestJsonFiles(paths, 3, &options);
+  }
+  remove(paths[0]);
+  remove(paths[2]);
+  if (status != FUNC_SUCCESS)
+  {
+    return status;
+  }
+
+  char cResult[512];
+  snprintf(cResult, sizeof(cResult), "%d %d", count.documents,
+           count.failures);
+  tryAssert(cResult, "4 2", "Ingest");
+  return FUNC_SUCCESS;
+}
+
+// Appends the literal of every token, or the bracket of a container, to the
+// trace
+static bool TraceEvent(json_view_t view, size_t, void *data)
+{
+  char *trace = (char *)data;
+  const size_t length =
+      view.type == JOBJECT || view.type == JARRAY ? 1 : view.length;
+  const size_t end = strlen(trace);
+  snprintf(&trace[end], 512 - end, "%.*s ", (int)length, view.str);
+  return true;
+}
+
+static bool StopAtKey(json_view_t, size_t, void *) { return false; }
+
+static status_json_t Test_Events(string_json_t json)
+{
+  char cResult[512] = "";
+  const event_handler_json_t handler = {
+      TraceEvent, TraceEvent, TraceEvent, TraceEvent, TraceEvent,
+      TraceEvent, TraceEvent, TraceEvent, TraceEvent, cResult,
+  };
+  status_json_t status;
+  if ((status = ParseJsonEvents(json.str, json.length, &handler)) !=
+      FUNC_SUCCESS)
+  {
+    return status;
+  }
+
+  tryAssert(cResult,
+            "{ \"version\" 2.5 \"tags\" [ \"C\" \"C++\" ] "
+            "\"isCompliant\" true } ",
+            "Events");
+  return FUNC_SUCCESS;
+}
+
+static status_json_t Test_Events_Errors(string_json_t)
+{
+  // The last document is just as malformed, but the handler stops first
+  const event_handler_json_t handler = {}, stopping = {.onKey = StopAtKey};
+  char cResult[512];
+  snprintf(cResult, sizeof(cResult), "%d %d %d %d %d",
+           ParseJsonEvents("{\"a\": [1, 2}", 12, &handler),
+           ParseJsonEvents("[1, 2,]", 7, &handler),
+           ParseJsonEvents("[1] 2", 5, &handler),
+           ParseJsonEvents("[tru]", 5, &handler),
+           ParseJsonEvents("{\"a\": [1, 2}", 12, &stopping));
+
+  tryAssert(cResult, "1 1 1 1 0", "Event errors");
+  return FUNC_SUCCESS;
+}
+
+static status_json_t Test_Probe(string_json_t json)
+{
+  static const char *const PATHS[] = {
+      "progName",    "version",     "metadata",        "metadata.device.pc",
+      "tags",        "isCompliant", "lastUpdated",     "metadata.missing",
+      "progName.pc", "missing",     "metadata..device", "metadata.pc"};
+
+  char cResult[512] = "";
+  for (size_t i = 0; i < sizeof(PATHS) / sizeof(PATHS[0]); i++)
+  {
+    json_view_t view = {};
+    const status_json_t status = ProbeJsonProperty(&json, PATHS[i], &view);
+    snprintf(&cResult[strlen(cResult)], sizeof(cResult) - strlen(cResult),
+             "%d ", status == FUNC_SUCCESS ? view.type : -status);
+  }
+  snprintf(&cResult[strlen(cResult)], sizeof(cResult) - strlen(cResult),
+           "%d %d", ProbeJsonProperty(&json, "devs", nullptr),
+           ProbeJsonProperty(&json, "dev", nullptr));
+
+  tryAssert(cResult, "2 0 1 2 3 4 5 -2 -2 -2 -2 -2 0 2", "Probe");
+  return FUNC_SUCCESS;
+}
+
+static status_json_t Test_Probe_Span(string_json_t json)
+{
+  json_view_t quote, flag, rows, temperature, on;
+  status_json_t status;
+  if ((status = ProbeJsonSpan(&json, "quote", &quote)) != FUNC_SUCCESS ||
+      (status = ProbeJsonSpan(&json, "flag", &flag)) != FUNC_SUCCESS ||
+      (status = ProbeJsonSpan(&json, "rows", &rows)) != FUNC_SUCCESS ||
+      (status = ProbeJsonSpan(&json, "temperature", &temperature)) !=
+          FUNC_SUCCESS ||
+      (status = ProbeJsonSpan(&json, "flag.on", &on)) != FUNC_SUCCESS)
+  {
+    return status;
+  }
+
+  char cResult[512];
+  snprintf(cResult, sizeof(cResult), "%.*s|%.*s|%.*s|%.*s|%.*s",
+           (int)quote.length, quote.str, (int)flag.length, flag.str,
+           (int)rows.length, rows.str, (int)temperature.length,
+           temperature.str, (int)on.length, on.str);
+  tryAssert(cResult,
+            "\"a\\\"b\\\\\"|{\"on\": true}|[[1, [2]], [\"]\"]]|-1.5e3|true",
+            "Probe span");
+  return FUNC_SUCCESS;
+}
+
+static status_json_t Test_Intern(string_json_t json)
+{
+  json_intern_t *table = malloc(sizeof(json_intern_t));
+  if (table == nullptr)
+  {
+    return MEMORY_FAILURE;
+  }
+  InitJsonIntern(table);
+
+  // Both points hold the keys x, y and on, in a different order
+  const char *keys[2][3] = {};
+  json_view_t root, points, point, key, value;
+  json_cursor_t rows, fields;
+  status_json_t status;
+  if ((status = ViewJson(json.str, json.length, &root)) != FUNC_SUCCESS ||
+      (status = ViewGetField(root, "points", &points)) != FUNC_SUCCESS ||
+      (status = ViewIterate(points, &rows)) != FUNC_SUCCESS)
+  {
+    free(table);
+    return status;
+  }
+  for (size_t row = 0;
+       row < 2 && ViewNextItem(&rows, &point) == FUNC_SUCCESS &&
+       ViewIterate(point, &fields) == FUNC_SUCCESS;
+       row++)
+  {
+    for (size_t k = 0;
+         k < 3 && ViewNextField(&fields, &key, &value) == FUNC_SUCCESS; k++)
+    {
+      ViewGetInternedString(table, key, &keys[row][k]);
+    }
+  }
+
+  const char *id = nullptr, *again = nullptr;
+  string_json_t result = {};
+  if ((status = GetProperty(json, &result, "id")) == FUNC_SUCCESS)
+  {
+    ConvertJsonToInternedString(table, &result, &id);
+    InternJsonString(table, "ab", 2, &again);
+  }
+
+  char cResult[512];
+  snprintf(cResult, sizeof(cResult), "%s %s %s %d %d %d %llu %llu",
+           keys[1][0], keys[1][1], keys[1][2], keys[1][0] == keys[0][2],
+           keys[1][2] == keys[0][0], id != nullptr && id == again,
+           table->hits, table->misses);
+  FreeJsonString(&result);
+  free(table);
+
+  tryAssert(cResult, "on y x 1 1 1 4 4", "Intern");
+  return status;
+}
+
+// Applies the patch to the target and appends the result to cResult
+static void AppendMerged(const char *target, const char *patch, char *cResult,
+                         size_t size)
+{
+  json_view_t targetView, patchView;
+  char merged[256];
+  size_t written;
+  status_json_t status;
+  if ((status = ViewJson(target, strlen(target), &targetView)) ==
+          FUNC_SUCCESS &&
+      (status = ViewJson(patch, strlen(patch), &patchView)) == FUNC_SUCCESS &&
+      (status = ApplyJsonMergePatch(targetView, patchView, merged,
+                                    sizeof(merged), &written)) == FUNC_SUCCESS)
+  {
+    snprintf(&cResult[strlen(cResult)], size - strlen(cResult), "%s ", merged);
+    return;
+  }
+  snprintf(&cResult[strlen(cResult)], size - strlen(cResult), "%d ", status);
+}
+
+// The examples of RFC 7386, appendix A, plus its section 3 example
+static status_json_t Test_Merge_Patch(string_json_t)
+{
+  static const char *const CASES[][2] = {
+      {"{\"a\":\"b\"}", "{\"a\":\"c\"}"},
+      {"{\"a\":\"b\"}", "{\"b\":\"c\"}"},
+      {"{\"a\":\"b\"}", "{\"a\":null}"},
+      {"{\"a\":\"b\",\"b\":\"c\"}", "{\"a\":null}"},
+      {"{\"a\":[\"b\"]}", "{\"a\":\"c\"}"},
+      {"{\"a\":\"c\"}", "{\"a\":[\"b\"]}"},
+      {"{\"a\":{\"b\":\"c\"}}",
+       "{\"a\":{\"b\":\"d\",\"c\":null}}"},
+      {"{\"a\":[{\"b\":\"c\"}]}", "{\"a\":[1]}"},
+      {"[\"a\",\"b\"]", "[\"c\",\"d\"]"},
+      {"{\"a\":\"b\"}", "[\"c\"]"},
+      {"{\"a\":\"foo\"}", "null"},
+      {"{\"e\":null}", "{\"a\":1}"},
+      {"[1,2]", "{\"a\":\"b\",\"c\":null}"},
+      {"{}", "{\"a\":{\"bb\":{\"ccc\":null}}}"},
+      {"{\"title\":\"Goodbye!\",\"author\":{\"givenName\":\"John\","
+       "\"familyName\":\"Doe\"},\"tags\":[\"example\",\"sample\"],"
+       "\"content\":\"This will be unchanged\"}",
+       "{\"title\":\"Hello!\",\"phoneNumber\":\"+01-555-555-5555\","
+       "\"author\":{\"familyName\":null},\"tags\":[\"example\"]}"},
+  };
+
+  char cResult[1024] = "";
+  for (size_t i = 0; i < sizeof(CASES) / sizeof(CASES[0]); i++)
+    AppendMerged(CASES[i][0], CASES[i][1], cResult, sizeof(cResult));
+
+  tryAssert(cResult,
+            "{\"a\":\"c\"} {\"a\":\"b\",\"b\":\"c\"} {} {\"b\":\"c\"} "
+            "{\"a\":\"c\"} {\"a\":[\"b\"]} {\"a\":{\"b\":\"d\"}} {\"a\":[1]} "
+            "[\"c\",\"d\"] [\"c\"] null {\"e\":null,\"a\":1} {\"a\":\"b\"} "
+            "{\"a\":{\"bb\":{}}} {\"title\":\"Hello!\",\"author\":{"
+            "\"givenName\":\"John\"},\"tags\":[\"example\"],\"content\":"
+            "\"This will be unchanged\",\"phoneNumber\":\"+01-555-555-5555\"} ",
+            "Merge patch");
+  return FUNC_SUCCESS;
+}
+
+static status_json_t Test_Diff(string_json_t json)
+{
+  // The edge document with one member changed, one removed, one added, a
+  // nested one changed and its whitespace rearranged
+  const char *modified =
+      "{ \"quote\": \"a\\\"b\\\\\", \"list\": [\"a\", \"c\"], "
+      "\"temperature\": -2, \"id\": \"ab\", \"flag\": {\"on\":false}, "
+      "\"rows\": [[1, [2]], [\"]\"]], \"points\": [{\"x\": 1, "
+      "\"y\": 2.5, \"on\": true}, {\"on\": null, \"y\": -1e1, \"x\": 3}],"
+      " \"new\": {\"deep\": [1]} }";
+  json_view_t original, changed, patch;
+  char cPatch[512], cMerged[512], cResult[1024];
+  size_t patchLength, mergedLength, sizeOnly, identicalLength;
+  status_json_t status;
+  if ((status = ViewJson(json.str, json.length, &original)) != FUNC_SUCCESS ||
+      (status = ViewJson(modified, strlen(modified), &changed)) !=
+          FUNC_SUCCESS ||
+      (status = DiffJson(original, changed, cPatch, sizeof(cPatch),
+                         &patchLength)) != FUNC_SUCCESS ||
+      (status = DiffJson(original, changed, nullptr, 0, &sizeOnly)) !=
+          FUNC_SUCCESS ||
+      (status = ViewJson(cPatch, patchLength, &patch)) != FUNC_SUCCESS ||
+      (status = ApplyJsonMergePatch(original, patch, cMerged, sizeof(cMerged),
+                                    &mergedLength)) != FUNC_SUCCESS)
+  {
+    return status;
+  }
+
+  // The patched document must now diff as identical to the modified one
+  char cIdentical[8];
+  json_view_t merged;
+  ViewJson(cMerged, mergedLength, &merged);
+  DiffJson(changed, merged, cIdentical, sizeof(cIdentical), &identicalLength);
+
+  // Nested objects that only differ in whitespace need no patch
+  const char *compact = "{\"o\":{\"a\":1}}";
+  const char *spaced = "{\"o\": { \"a\": 1 }}";
+  char cSpaced[8];
+  json_view_t before, after;
+  ViewJson(compact, strlen(compact), &before);
+  ViewJson(spaced, strlen(spaced), &after);
+  DiffJson(before, after, cSpaced, sizeof(cSpaced), &identicalLength);
+
+  // Setting a member to null cannot be expressed as a merge patch
+  const char *withNull = "{\"o\": null}";
+  ViewJson(withNull, strlen(withNull), &after);
+
+  snprintf(cResult, sizeof(cResult), "%s %d %s %s %d %d", cPatch,
+           sizeOnly == patchLength, cIdentical, cSpaced,
+           DiffJson(before, after, cPatch, sizeof(cPatch), &patchLength),
+           DiffJson(original, changed, cPatch, 8, &patchLength));
+  tryAssert(cResult,
+            "{\"temperature\":-2,\"flag\":{\"on\":false},\"c\":null,"
+            "\"new\":{\"deep\":[1]}} 1 {} {} 1 -1",
+            "Diff");
+  return FUNC_SUCCESS;
+}
+
+static status_json_t Test_Project(string_json_t json)
+{
+  // Arrays are not walked into, and paths to missing members are dropped
+  const char *paths[] = {"quote",     "flag.on",  "rows",
+                         "missing.x", "points.x", "c"};
+  const size_t countPaths = sizeof(paths) / sizeof(paths[0]);
+  json_view_t view, item;
+  char cProjected[256], cResult[512];
+  size_t projectedLength, sizeOnly;
+  status_json_t status;
+  if ((status = ViewJson(json.str, json.length, &view)) != FUNC_SUCCESS ||
+      (status = ProjectJson(view, paths, countPaths, cProjected,
+                            sizeof(cProjected), &projectedLength)) !=
+          FUNC_SUCCESS ||
+      (status = ProjectJson(view, paths, countPaths, nullptr, 0,
+                            &sizeOnly)) != FUNC_SUCCESS)
+  {
+    return status;
+  }
+
+  const char *list = "[1]";
+  ViewJson(list, strlen(list), &item);
+  char cSmall[8];
+  snprintf(cResult, sizeof(cResult), "%s %d %d %d", cProjected,
+           sizeOnly == projectedLength,
+           ProjectJson(view, paths, countPaths, cSmall, sizeof(cSmall),
+                       &projectedLength),
+           ProjectJson(item, paths, countPaths, cSmall, sizeof(cSmall),
+                       &projectedLength));
+  tryAssert(cResult,
+            "{\"quote\":\"a\\\"b\\\\\",\"flag\":{\"on\":true},"
+            "\"rows\":[[1, [2]], [\"]\"]],\"c\":0} 1 -1 1",
+            "Project");
+  return FUNC_SUCCESS;
+}
+
+// The second record shifts every key after the first value: id is found at
+// its offset, name right after the value of id and score is scanned for, since
+// it does not follow name. The third record changes the order
+static status_json_t Test_Predict(string_json_t)
+{
+  const char *records[] = {
+      "{\"id\": 1, \"name\": \"ann\", \"tags\": [\"a\"], \"score\": 10}",
+      "{\"id\": 22, \"name\": \"bo\", \"tags\": [\"a\", \"b\"], \"score\": 7}",
+      "{\"score\": 3, \"id\": 4}",
+  };
+  const char *keys[][3] = {
+      {"id", "name", "score"}, {"id", "name", "score"}, {"score", "id"}};
+  const size_t countKeys[] = {3, 3, 2};
+  json_predictor_t *predictor = malloc(sizeof(json_predictor_t));
+  if (predictor == nullptr)
+    return MEMORY_FAILURE;
+  InitJsonPredictor(predictor);
+
+  string_json_t record = {}, result = {};
+  char cResult[256] = "", cValue[64];
+  status_json_t status = FUNC_SUCCESS;
+  for (size_t r = 0; r < 3 && status == FUNC_SUCCESS; r++)
+  {
+    status = ConvertStringToJson(records[r], &record);
+    for (size_t k = 0; k < countKeys[r] && status == FUNC_SUCCESS; k++)
+    {
+      if ((status = PredictedGetProperty(predictor, &record, &result,
+                                         keys[r][k])) == FUNC_SUCCESS)
+      {
+        ConvertJsonToString(result, cValue);
+        strcat(cResult, cValue);
+        strcat(cResult, " ");
+      }
+    }
+  }
+  snprintf(&cResult[strlen(cResult)], sizeof(cResult) - strlen(cResult),
+           "%llu/%llu", predictor->hits, predictor->misses);
+  free(predictor);
+  FreeJsonString(&record);
+  FreeJsonString(&result);
+  if (status != FUNC_SUCCESS)
+    return status;
+
+  tryAssert(cResult, "1 ann 10 22 bo 7 3 4 2/6", "Predict");
+  return FUNC_SUCCESS;
+}
+
+// Offsets past USHRT_MAX only fit the large and dynamic profiles; The others
+// must refuse the document instead of truncating it
+static status_json_t Test_Large_Document(string_json_t)
+{
+  constexpr size_t PADDING = 70000;
+  char *text = malloc(PADDING + 32);
+  string_json_t *document = calloc(1, sizeof(string_json_t));
+  json_cache_t *cache = malloc(sizeof(json_cache_t));
+  if (text == nullptr || document == nullptr || cache == nullptr)
+  {
+    free(text);
+    free(document);
+    free(cache);
+    return MEMORY_FAILURE;
+  }
+  InitJsonCache(cache);
+
+  const int prefix = snprintf(text, PADDING + 32, "{\"pad\": \"");
+  memset(&text[prefix], 'x', PADDING);
+  snprintf(&text[prefix + PADDING], 32, "\", \"last\": 7}");
+
+  char cResult[512];
+  string_json_t result = {};
+  status_json_t status = ConvertStringToJson(text, document);
+  if (status == FUNC_SUCCESS &&
+      (status = CachedGetProperty(cache, document, &result, "last")) ==
+          FUNC_SUCCESS &&
+      (status = CachedGetProperty(cache, document, &result, "last")) ==
+          FUNC_SUCCESS)
+  {
+    ConvertJsonToString(result, cResult);
+    snprintf(&cResult[strlen(cResult)], sizeof(cResult) - strlen(cResult),
+             " %llu", cache->hits);
+  }
+  else
+  {
+    snprintf(cResult, sizeof(cResult), "%d", status);
+  }
+  FreeJsonString(&result);
+  FreeJsonString(document);
+  free(text);
+  free(document);
+  free(cache);
+
+  tryAssert(cResult, JSONBUFFSIZE > PADDING + 32 ? "7 1" : "-1",
+            "Large document");
   return FUNC_SUCCESS;
 }
 
@@ -306,13 +1533,40 @@ int main()
       "\"isCompliant\": false, \"lastUpdated\": null, \"devs\": "
       "[], \"other\": {} }";
 
-  string_json_t jsonStr;
+  char cPrettyJsonStr[] = "\n{\r\n"
+                          "\t\"version\":\t2.5,\r\n"
+                          "\t\"tags\": [\n\t\t\"C\",\n\t\t\"C++\"\n\t],\n"
+                          "\t\"isCompliant\":\n\t\ttrue\n"
+                          "}\n";
+
+  char cEdgeJsonStr[] =
+      "{ \"quote\": \"a\\\"b\\\\\", \"list\": [\"a\", \"c\"], "
+      "\"temperature\": -1.5e3, \"id\": \"ab\", \"flag\": {\"on\": true}, "
+      "\"rows\": [[1, [2]], [\"]\"]], \"c\"  : 0, \"points\": [{\"x\": 1, "
+      "\"y\": 2.5, \"on\": true}, {\"on\": null, \"y\": -1e1, \"x\": 3}] }";
+
+  // Static so that the large profile keeps them off the stack
+  static string_json_t jsonStr;
   status_json_t status;
   if ((status = ConvertStringToJson(cJsonStr, &jsonStr)) != FUNC_SUCCESS)
   {
     return status;
   }
 
+  static string_json_t edgeJsonStr;
+  if ((status = ConvertStringToJson(cEdgeJsonStr, &edgeJsonStr)) !=
+      FUNC_SUCCESS)
+  {
+    return status;
+  }
+
+  static string_json_t prettyJsonStr;
+  if ((status = ConvertStringToJson(cPrettyJsonStr, &prettyJsonStr)) !=
+      FUNC_SUCCESS)
+  {
+    return status;
+  }
+
   float startTime = (float)clock() / CLOCKS_PER_SEC;
 
   Test_String(jsonStr);
@@ -328,9 +1582,48 @@ int main()
   Test_Nested_Object(jsonStr);
   Test_Missing_Key(jsonStr);
   Test_Array_Concat(jsonStr);
+  Test_Pretty_Number(prettyJsonStr);
+  Test_Pretty_Boolean(prettyJsonStr);
+  Test_Pretty_Array_Concat(prettyJsonStr);
+  Test_Parser_In_Place(jsonStr);
+  Test_Parser_Depth(jsonStr);
+  Test_Stats(jsonStr);
+  Test_Escaped_String(edgeJsonStr);
+  Test_Two_Character_String(edgeJsonStr);
+  Test_Negative_Exponent_Number(edgeJsonStr);
+  Test_Nested_Boolean(edgeJsonStr);
+  Test_Array_Item_Not_Key(edgeJsonStr);
+  Test_Nested_Array_Concat(edgeJsonStr);
+  Test_Tape_Lookup(jsonStr);
+  Test_Tape_Reload(edgeJsonStr);
+  Test_Tape_Surrogates(edgeJsonStr);
+  Test_Tape_Long_String(edgeJsonStr);
+  Test_Cache(jsonStr);
+  Test_Cache_Refill(jsonStr);
+  Test_View_Fields(jsonStr);
+  Test_View_Iteration(jsonStr);
+  Test_Number_Conversion(edgeJsonStr);
+  Test_Number_Errors(edgeJsonStr);
+  Test_Number_Array(edgeJsonStr);
+  Test_Columns(edgeJsonStr);
+  Test_Ingest(jsonStr);
+  Test_Events(prettyJsonStr);
+  Test_Events_Errors(edgeJsonStr);
+  Test_Large_Document(jsonStr);
+  Test_Probe(jsonStr);
+  Test_Probe_Span(edgeJsonStr);
+  Test_Intern(edgeJsonStr);
+  Test_Merge_Patch(jsonStr);
+  Test_Diff(edgeJsonStr);
+  Test_Project(edgeJsonStr);
+  Test_Predict(jsonStr);
 
   float endTime = (float)clock() / CLOCKS_PER_SEC;
   float elapsed = endTime - startTime;
   printf("All cases passed with a time of %f\n", elapsed);
+
+  FreeJsonString(&jsonStr);
+  FreeJsonString(&edgeJsonStr);
+  FreeJsonString(&prettyJsonStr);
   return 0;
 }